@@ -0,0 +1,538 @@
+/**
+ * @file gddalgo_bench.cpp
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 算法端到端吞吐测试, 全速推理并输出 JSON (帧率, 延迟分位数, 各阶段耗时, 进程峰值内存)
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * 用法: gddalgo_bench [选项]
+ *   --algo <name|all>        测试算法, 默认 all
+ *   --frames <N>             每个算法推理帧数, 默认 500
+ *   --mode <sync|async|pipeline>
+ *                            推理模式, 不支持异步的算法使用同步, pipeline 为 InferPipeline, 默认 sync
+ *   --inflight <N>           异步/pipeline 模式最大在途帧数, 默认 8
+ *   --streams <N>            视频流数 (轮流分配帧), 默认 1
+ *   --backend <mock|device>  推理后端, 默认 mock
+ *   --latency <us>           模拟后端单次推理耗时, 默认 5000
+ *   --item-latency <us>      模拟后端批内每个输入耗时, 默认 500
+ *   --model-dir <dir>        模型目录 (device), 默认 ../models
+ *   --video <path>           预读视频帧作为输入, 默认生成纯色图像
+ *   --size <W>x<H>           生成图像尺寸, 默认 1920x1080
+ *   --record <path>          录制检测结果
+ *   --replay <path>          回放检测结果 (不运行模型)
+ *   --replay-latency <us>    回放时模拟单次推理耗时, 默认 0 (只测主机侧开销)
+ *   --trace <path>           导出各阶段时间线 (Chrome trace)
+ *   --output <path>          JSON 输出文件, 默认标准输出
+ *
+ * 峰值内存 (ru_maxrss) 在进程内只增不减, 只在顶层输出一次, 测试单个算法的峰值需 --algo 单独运行
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#include "cover_plate_algo.h"
+#include "detection_record.h"
+#include "door_hat_algo.h"
+#include "helmet_algo.h"
+#include "hoisting_operation_algo.h"
+#include "infer_pipeline.h"
+#include "light_glove_algo.h"
+#include "light_goggle_algo.h"
+#include "light_leavepost_algo.h"
+#include "light_mask_algo.h"
+#include "light_person_algo.h"
+#include "mock_infer_backend.h"
+#include "person_algo.h"
+#include "pipeline_trace.h"
+#include "person_misc_algo.h"
+#include "play_phone_algo.h"
+#include "safety_belt_algo.h"
+#include "smoke_algo.h"
+#include "sparks_cover_algo.h"
+#include "weld_glove_algo.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+#include <sstream>
+#include <sys/resource.h>
+#include <type_traits>
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::string algo{"all"};
+    int64_t frames{500};
+    std::string mode{"sync"};
+    uint32_t inflight{8};
+    int streams{1};
+    std::string backend{"mock"};
+    uint32_t latency{5000};
+    uint32_t item_latency{500};
+    std::string model_dir{"../models"};
+    std::string video_path;
+    cv::Size size{1920, 1080};
+    std::string record_path;
+    std::string replay_path;
+    uint32_t replay_latency{0};
+    std::string trace_path;
+    std::string output_path;
+};
+
+// 模型描述, 路径为 model_dir/<file>.gdd, 授权为 model_dir/license_<file>.gdd
+struct BenchModel {
+    std::string name;
+    std::string file;
+    float threshold;
+    std::set<std::string> labels;
+    bool crop{false};// 裁剪阶段模型 (模拟后端按裁剪尺寸生成目标)
+    float crop_scale_factor{1.0f};
+};
+
+// 类型擦除的算法接口
+struct BenchRunner {
+    std::function<bool(const std::vector<gddi::ModelConfig> &)> load_models;
+    std::function<bool(const int, const int64_t, const cv::Mat &, std::vector<gddi::AlgoObject> &)> sync_infer;
+    std::function<void(const int, const int64_t, const cv::Mat &, gddi::InferCallback)> async_infer;// 空为不支持
+    std::function<uint64_t()> dropped_frames;
+    std::function<gddi::AlgoMetrics()> get_metrics;
+    std::function<std::shared_ptr<gddi::InferPipeline>(const size_t)> create_pipeline;
+};
+
+template<typename Algo, typename = void>
+struct HasAsyncInfer : std::false_type {};
+
+template<typename Algo>
+struct HasAsyncInfer<Algo, std::void_t<decltype(std::declval<Algo &>().async_infer(
+                               0, int64_t(0), std::declval<const cv::Mat &>(), gddi::InferCallback{}))>>
+    : std::true_type {};
+
+template<typename Algo, typename Config>
+BenchRunner make_runner(const uint32_t inflight) {
+    auto algo = std::make_shared<Algo>(Config{});
+
+    BenchRunner runner;
+    runner.load_models = [algo](const std::vector<gddi::ModelConfig> &models) { return algo->load_models(models); };
+    runner.sync_infer = [algo](const int stream_id, const int64_t image_id, const cv::Mat &image,
+                               std::vector<gddi::AlgoObject> &objects) {
+        return algo->sync_infer(stream_id, image_id, image, objects);
+    };
+    runner.get_metrics = [algo]() { return algo->get_metrics(); };
+    runner.create_pipeline = [algo](const size_t depth) { return std::make_shared<gddi::InferPipeline>(*algo, depth); };
+    if constexpr (HasAsyncInfer<Algo>::value) {
+        gddi::FlowControlConfig flow_control;
+        flow_control.max_inflight = inflight;
+        algo->set_flow_control(flow_control);
+
+        runner.async_infer = [algo](const int stream_id, const int64_t image_id, const cv::Mat &image,
+                                    gddi::InferCallback callback) {
+            algo->async_infer(stream_id, image_id, image, callback);
+        };
+        runner.dropped_frames = [algo]() { return algo->dropped_frames(); };
+    }
+    return runner;
+}
+
+struct BenchAlgo {
+    std::string name;
+    std::vector<BenchModel> models;
+    std::function<BenchRunner(const uint32_t)> create;
+};
+
+static std::vector<BenchAlgo> bench_algos() {
+    return {
+        {"cover_plate", {{"cover_plate", "cover_plate", 0.3, {"uncover_plate"}}},
+         make_runner<gddi::Cover_PlateAlgo, gddi::Cover_PlateAlgoConfig>},
+        {"door_hat",
+         {{"door", "door", 0.3, {"close"}}, {"hat", "hat", 0.3, {"un_hat"}}},
+         make_runner<gddi::DoorHatAlgo, gddi::DoorHatAlgoConfig>},
+        {"helmet",
+         {{"person", "person", 0.2, {"person"}}, {"helmet", "helmet", 0.2, {"helmet", "head"}, true}},
+         make_runner<gddi::HelmetAlgo, gddi::HelmetAlgoConfig>},
+        {"hoisting_operation",
+         {{"light_model", "hoisting_light", 0.3, {"light_on"}},
+          {"hoisting_model", "hoisting_body", 0.3, {"structure_body"}},
+          {"person_model", "person", 0.3, {"person"}, true, 1.5f}},
+         make_runner<gddi::HoistingOperationAlgo, gddi::HoistingOperationAlgoConfig>},
+        {"light_glove",
+         {{"light", "light", 0.3, {"light_on"}},
+          {"person", "person", 0.8, {"person"}},
+          {"glove", "glove", 0.3, {"glove"}, true}},
+         make_runner<gddi::LightGloveAlgo, gddi::LightGloveAlgoConfig>},
+        {"light_goggle",
+         {{"light", "light", 0.3, {"light_on"}},
+          {"person", "person", 0.8, {"person"}},
+          {"goggle", "goggle", 0.3, {"goggle"}, true}},
+         make_runner<gddi::LightGoggleAlgo, gddi::LightGoggleAlgoConfig>},
+        {"light_leavepost",
+         {{"light", "light", 0.3, {"light_on"}}, {"person", "person", 0.5, {"person"}}},
+         make_runner<gddi::Light_LeavepostAlgo, gddi::Light_LeavepostAlgoConfig>},
+        {"light_mask",
+         {{"light", "light", 0.3, {"light_on"}},
+          {"person", "person", 0.8, {"person"}},
+          {"mask", "mask", 0.3, {"mask"}, true}},
+         make_runner<gddi::LightMaskAlgo, gddi::LightMaskAlgoConfig>},
+        {"light_person",
+         {{"light", "light", 0.3, {"light_on"}}, {"person", "person", 0.5, {"person"}}},
+         make_runner<gddi::LightPersonAlgo, gddi::LightPersonAlgoConfig>},
+        {"person", {{"person", "person", 0.3, {"person"}}}, make_runner<gddi::PersonAlgo, gddi::PersonAlgoConfig>},
+        {"person_misc",
+         {{"person", "person", 0.3, {"person"}},
+          {"foreign_object", "foreign_object", 0.5, {"foreign_matter1", "foreign_matter2", "foreign_matter3"}}},
+         make_runner<gddi::Person_MiscAlgo, gddi::Person_MiscAlgoConfig>},
+        {"play_phone",
+         {{"person", "person", 0.8, {"person"}}, {"phone", "phone", 0.3, {"hand", "phone", "head"}, true}},
+         make_runner<gddi::PlayPhoneAlgo, gddi::PlayPhoneAlgoConfig>},
+        {"safety_belt",
+         {{"person", "person", 0.3, {"person"}},
+          {"safety_belt", "safety_belt", 0.3, {"safety_belt"}, true},
+          {"safety_belt_light", "safety_belt_light", 0.3, {"light_on"}}},
+         make_runner<gddi::SafetyBeltAlgo, gddi::SafetyBeltAlgoConfig>},
+        {"smoke",
+         {{"person", "person", 0.3, {"person"}}, {"smoke", "smoke", 0.3, {"hand", "smoke"}, true}},
+         make_runner<gddi::SmokeAlgo, gddi::SmokeAlgoConfig>},
+        {"sparks_cover",
+         {{"light", "sparks", 0.3, {"sparks"}},
+          {"person", "person", 0.6, {"person"}, true, 4.0f},
+          {"cover", "cover", 0.3, {"cover"}, true, 1.5f}},
+         make_runner<gddi::SparksCoverAlgo, gddi::SparksCoverAlgoConfig>},
+        {"weld_glove",
+         {{"weld", "welding", 0.3, {"sparks"}},
+          {"person", "person", 0.1, {"person"}},
+          {"glove", "glove", 0.3, {"glove"}, true}},
+         make_runner<gddi::WeldGloveAlgo, gddi::WeldGloveAlgoConfig>},
+    };
+}
+
+// 按模型统计推理耗时 (提交到结果返回)
+struct ModelTiming {
+    uint64_t calls{0};
+    uint64_t items{0};
+    double total_ms{0};
+};
+
+static std::mutex g_timing_mutex;
+static std::map<std::string, ModelTiming> g_model_timings;
+
+class TimingBackend : public gddi::InferBackend {
+public:
+    TimingBackend(const gddi::InferBackendPtr &backend) : backend_(backend) {}
+
+    bool load(const gddi::ModelConfig &model) override {
+        name_ = model.name;
+        return backend_->load(model);
+    }
+
+    bool infer_sync(const gddi::InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override {
+        auto start = Clock::now();
+        auto success = backend_->infer_sync(tag, in_package, out_package);
+        record(start, in_package->data.size());
+        return success;
+    }
+
+    void infer_async(const gddi::InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     gddi::InferBackendCallback callback) override {
+        auto start = Clock::now();
+        auto items = in_package->data.size();
+        backend_->infer_async(tag, in_package,
+                              [this, start, items, callback](const gddi::InferTag &tag, bool success,
+                                                             const gddeploy::PackagePtr &out_package) {
+                                  record(start, items);
+                                  callback(tag, success, out_package);
+                              });
+    }
+
+    void wait_task_done() override { backend_->wait_task_done(); }
+
+private:
+    void record(const Clock::time_point &start, const size_t items) {
+        std::lock_guard<std::mutex> lock(g_timing_mutex);
+        auto &timing = g_model_timings[name_];
+        timing.calls++;
+        timing.items += items;
+        timing.total_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    gddi::InferBackendPtr backend_;
+    std::string name_;
+};
+
+static void write_histogram(std::ostringstream &json, const std::string &name,
+                            const gddi::LatencyHistogram &histogram) {
+    json << "\"" << name << "\":{\"count\":" << histogram.count << ",\"mean_us\":" << histogram.mean_us()
+         << ",\"p50_us\":" << histogram.percentile_us(0.5) << ",\"p99_us\":" << histogram.percentile_us(0.99)
+         << ",\"max_us\":" << histogram.max_us << "}";
+}
+
+static double percentile(std::vector<double> values, const double ratio) {
+    if (values.empty()) { return 0; }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(ratio * (values.size() - 1) + 0.5))];
+}
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static bool parse_options(int argc, char **argv, BenchOptions &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        if (i + 1 >= argc) {
+            printf("Missing value: %s\n", key.c_str());
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (key == "--algo") {
+            options.algo = value;
+        } else if (key == "--frames") {
+            options.frames = std::stoll(value);
+        } else if (key == "--mode") {
+            options.mode = value;
+        } else if (key == "--inflight") {
+            options.inflight = std::stoul(value);
+        } else if (key == "--streams") {
+            options.streams = std::max(1, std::stoi(value));
+        } else if (key == "--backend") {
+            options.backend = value;
+        } else if (key == "--latency") {
+            options.latency = std::stoul(value);
+        } else if (key == "--item-latency") {
+            options.item_latency = std::stoul(value);
+        } else if (key == "--model-dir") {
+            options.model_dir = value;
+        } else if (key == "--video") {
+            options.video_path = value;
+        } else if (key == "--size") {
+            if (sscanf(value.c_str(), "%dx%d", &options.size.width, &options.size.height) != 2) { return false; }
+        } else if (key == "--record") {
+            options.record_path = value;
+        } else if (key == "--replay") {
+            options.replay_path = value;
+        } else if (key == "--replay-latency") {
+            options.replay_latency = std::stoul(value);
+        } else if (key == "--trace") {
+            options.trace_path = value;
+        } else if (key == "--output") {
+            options.output_path = value;
+        } else {
+            printf("Unknown option: %s\n", key.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<cv::Mat> load_frames(const BenchOptions &options) {
+    std::vector<cv::Mat> frames;
+    if (!options.video_path.empty()) {
+        // 预读帧, 不计入解码耗时
+        auto capture = cv::VideoCapture(options.video_path);
+        cv::Mat frame;
+        while ((int64_t)frames.size() < std::min<int64_t>(options.frames, 300) && capture.read(frame)) {
+            frames.emplace_back(frame.clone());
+        }
+    }
+
+    if (frames.empty()) { frames.emplace_back(options.size, CV_8UC3, cv::Scalar(114, 114, 114)); }
+    return frames;
+}
+
+static std::string run_algo(const BenchAlgo &bench_algo, const BenchOptions &options,
+                            const std::vector<cv::Mat> &frames) {
+    std::vector<gddi::ModelConfig> models;
+    for (const auto &item : bench_algo.models) {
+        models.emplace_back(gddi::ModelConfig{item.name, options.model_dir + "/" + item.file + ".gdd",
+                                              options.model_dir + "/license_" + item.file + ".gdd", item.threshold,
+                                              item.labels, item.crop_scale_factor});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_timing_mutex);
+        g_model_timings.clear();
+    }
+
+    auto runner = bench_algo.create(options.inflight);
+    if (!runner.load_models(models)) {
+        printf("Failed to load models: %s\n", bench_algo.name.c_str());
+        return "";
+    }
+
+    auto mode = options.mode;
+    if (mode == "async" && !runner.async_infer) { mode = "sync"; }
+    bool async = mode == "async";
+    std::vector<double> latencies;
+    latencies.reserve(options.frames);
+    uint64_t object_number = 0;
+
+    auto start = Clock::now();
+    if (async) {
+        std::mutex result_mutex;
+        std::condition_variable result_cv;
+        int64_t finished_frames = 0;
+        std::vector<Clock::time_point> submit_times(options.frames);
+
+        for (int64_t i = 0; i < options.frames; i++) {
+            submit_times[i] = Clock::now();
+            auto callback = [&](const int64_t image_id, const cv::Mat &, const std::vector<gddi::AlgoObject> &objects) {
+                auto cost = std::chrono::duration<double, std::milli>(Clock::now() - submit_times[image_id]);
+                std::lock_guard<std::mutex> lock(result_mutex);
+                latencies.emplace_back(cost.count());
+                object_number += objects.size();
+                finished_frames++;
+                result_cv.notify_all();
+            };
+            runner.async_infer(i % options.streams, i, frames[i % frames.size()], callback);
+        }
+
+        // 等待全部回调 (丢帧不回调)
+        std::unique_lock<std::mutex> lock(result_mutex);
+        result_cv.wait(lock, [&] { return finished_frames + (int64_t)runner.dropped_frames() >= options.frames; });
+    } else if (mode == "pipeline") {
+        std::vector<Clock::time_point> submit_times(options.frames);
+        auto pipeline = runner.create_pipeline(options.inflight);
+        gddi::PipelineResult result;
+        auto collect = [&]() {
+            latencies.emplace_back(
+                std::chrono::duration<double, std::milli>(Clock::now() - submit_times[result.image_id]).count());
+            object_number += result.objects.size();
+        };
+
+        for (int64_t i = 0; i < options.frames; i++) {
+            submit_times[i] = Clock::now();
+            pipeline->submit(i % options.streams, i, frames[i % frames.size()]);
+            while (pipeline->poll(result)) { collect(); }
+        }
+        while (pipeline->poll(result, true)) { collect(); }
+    } else {
+        for (int64_t i = 0; i < options.frames; i++) {
+            std::vector<gddi::AlgoObject> objects;
+            auto frame_start = Clock::now();
+            runner.sync_infer(i % options.streams, i, frames[i % frames.size()], objects);
+            latencies.emplace_back(std::chrono::duration<double, std::milli>(Clock::now() - frame_start).count());
+            object_number += objects.size();
+        }
+    }
+    auto total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::ostringstream json;
+    json << "{\"algo\":\"" << bench_algo.name << "\",\"mode\":\"" << mode
+         << "\",\"frames\":" << latencies.size() << ",\"objects\":" << object_number
+         << ",\"dropped_frames\":" << (async ? runner.dropped_frames() : 0) << ",\"total_ms\":" << total_ms
+         << ",\"fps\":" << (total_ms > 0 ? latencies.size() * 1000.0 / total_ms : 0);
+
+    double latency_sum = 0;
+    for (auto latency : latencies) { latency_sum += latency; }
+    json << ",\"latency_ms\":{\"mean\":" << (latencies.empty() ? 0 : latency_sum / latencies.size())
+         << ",\"p50\":" << percentile(latencies, 0.5) << ",\"p95\":" << percentile(latencies, 0.95)
+         << ",\"p99\":" << percentile(latencies, 0.99) << ",\"max\":" << percentile(latencies, 1.0) << "}";
+
+    // 各模型推理耗时, 同步模式下其余为主机侧耗时 (转换/解析/跟踪/统计)
+    double infer_ms = 0;
+    json << ",\"stages\":[";
+    {
+        std::lock_guard<std::mutex> lock(g_timing_mutex);
+        bool first = true;
+        for (const auto &item : g_model_timings) {
+            json << (first ? "" : ",") << "{\"model\":\"" << item.first << "\",\"calls\":" << item.second.calls
+                 << ",\"items\":" << item.second.items << ",\"total_ms\":" << item.second.total_ms
+                 << ",\"mean_ms\":" << (item.second.calls > 0 ? item.second.total_ms / item.second.calls : 0) << "}";
+            infer_ms += item.second.total_ms;
+            first = false;
+        }
+    }
+    json << "]";
+    if (mode == "sync") { json << ",\"host_ms\":" << std::max(0.0, total_ms - infer_ms); }
+
+    // 算法内部指标 (主机侧各阶段)
+    auto metrics = runner.get_metrics();
+    json << ",\"crops\":" << metrics.crops << ",\"truncated_crops\":" << metrics.truncated_crops
+         << ",\"cached_detections\":" << metrics.cached_detections << ",\"cached_crops\":" << metrics.cached_crops
+         << ",\"motion_skipped\":" << metrics.motion_skipped << ",\"zone_filtered\":" << metrics.zone_filtered
+         << ",\"host_stages\":{";
+    write_histogram(json, "convert", metrics.convert);
+    json << ",";
+    write_histogram(json, "parse", metrics.parse);
+    json << ",";
+    write_histogram(json, "track", metrics.track);
+    json << ",";
+    write_histogram(json, "cover_merge", metrics.cover_merge);
+    json << ",";
+    write_histogram(json, "statistic", metrics.statistic);
+    json << "}}";
+
+    return json.str();
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) { return -1; }
+
+    // 推理后端: 回放 > 模拟 > 设备, 外层计时
+    if (!options.replay_path.empty()) {
+        if (!gddi::start_detection_replay(options.replay_path, options.replay_latency)) { return -1; }
+    } else if (options.backend == "mock") {
+        std::map<std::string, bool> crop_models;
+        for (const auto &algo : bench_algos()) {
+            for (const auto &model : algo.models) {
+                crop_models[options.model_dir + "/" + model.file + ".gdd"] |= model.crop;
+            }
+        }
+
+        gddi::set_infer_backend([options, crop_models](const gddi::ModelConfig &model) -> gddi::InferBackendPtr {
+            gddi::MockInferBackendConfig config;
+            config.latency = options.latency;
+            config.item_latency = options.item_latency;
+            config.input_size = options.size;
+            auto iter = crop_models.find(model.path);
+            if (iter != crop_models.end() && iter->second) { config.input_size = cv::Size{256, 512}; }
+            return std::make_shared<gddi::MockInferBackend>(config);
+        });
+    }
+
+    auto creator = gddi::get_infer_backend();
+    gddi::set_infer_backend([creator](const gddi::ModelConfig &model) -> gddi::InferBackendPtr {
+        auto backend = creator(model);
+        return backend ? std::make_shared<TimingBackend>(backend) : nullptr;
+    });
+
+    if (!options.record_path.empty() && !gddi::start_detection_record(options.record_path)) { return -1; }
+
+    auto frames = load_frames(options);
+    if (!options.trace_path.empty()) { gddi::start_pipeline_trace(); }
+
+    std::vector<std::string> results;
+    for (const auto &algo : bench_algos()) {
+        if (options.algo != "all" && options.algo != algo.name) { continue; }
+
+        auto result = run_algo(algo, options, frames);
+        if (!result.empty()) { results.emplace_back(result); }
+    }
+
+    std::ostringstream json;
+    json << "{\"backend\":\"" << (options.replay_path.empty() ? options.backend : "replay")
+         << "\",\"frames\":" << options.frames << ",\"streams\":" << options.streams << ",\"width\":"
+         << frames.front().cols << ",\"height\":" << frames.front().rows << ",\"peak_rss_kb\":" << peak_rss_kb()
+         << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); i++) { json << (i > 0 ? "," : "") << results[i]; }
+    json << "]}\n";
+
+    if (options.output_path.empty()) {
+        printf("%s", json.str().c_str());
+    } else {
+        std::ofstream file(options.output_path);
+        file << json.str();
+    }
+
+    gddi::stop_detection_record();
+    if (!options.trace_path.empty()) { gddi::stop_pipeline_trace(options.trace_path); }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file algo_group.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 多算法组合, 同一帧上多个算法共享整帧检测 (如行人检测只执行一次)
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "cascade_algo.h"
+#include "struct_def.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+class Cascade;
+
+using GroupInferCallback =
+    std::function<void(const int64_t, const cv::Mat &, const std::map<std::string, std::vector<AlgoObject>> &)>;
+
+class AlgoGroup {
+public:
+    AlgoGroup();
+    ~AlgoGroup();
+
+    /**
+     * @brief 添加算法, 算法需已加载模型且生命周期长于 AlgoGroup
+     *
+     * 相同模型文件+阈值的整帧检测 (如行人检测) 在组内每帧只执行一次, 各算法按自身标签/阈值解析结果
+     *
+     * 跟踪不在组内共享: 各算法跟踪前的目标因标签/阈值/检测区域不同而不同, 且跟踪ID需在算法内连续,
+     * 因此跟踪/统计状态及第二阶段裁剪检测 (模型各不相同) 仍由各算法独立执行
+     *
+     * @param name 算法名称 (结果键值, 需唯一)
+     * @param algo 算法实例 (SmokeAlgo, PlayPhoneAlgo, SafetyBeltAlgo ...)
+     */
+    void add_algo(const std::string &name, CascadeAlgo &algo) {
+        add_cascade(name, algo.cascade());
+    }
+
+    /**
+     * @brief 异步推理接口, 全部算法完成后回调
+     *
+     * 任一算法按流控策略丢弃该帧 (见 FlowControlConfig) 时, 该帧不回调
+     *
+     * @param stream_id 视频流ID
+     * @param image_id  帧ID
+     * @param image     图像
+     * @param callback  回调, 结果按算法名称索引
+     */
+    void async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image, GroupInferCallback callback);
+
+    /**
+     * @brief 同步推理接口
+     *
+     * @param stream_id 视频流ID
+     * @param image_id
+     * @param image
+     * @param objects   结果按算法名称索引
+     * @return true
+     * @return false 任一算法推理失败
+     */
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::map<std::string, std::vector<AlgoObject>> &objects);
+
+private:
+    void add_cascade(const std::string &name, Cascade *cascade);
+
+    class AlgoGroupPrivate;
+    std::unique_ptr<AlgoGroupPrivate> private_;
+};
+
+}// namespace gddi
@@ -0,0 +1,73 @@
+/**
+ * @file cascade_algo.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 级联算法公共接口, 视频流/流控/检测区域/指标等设置统一转发到级联引擎
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "struct_def.h"
+#include <memory>
+
+namespace gddi {
+
+class Cascade;
+
+class CascadeAlgo {
+public:
+    /**
+     * @brief 释放视频流状态 (如摄像头下线)
+     * 
+     * @param stream_id 视频流ID
+     */
+    void release_stream(const int stream_id);
+
+    /**
+     * @brief 设置单路视频流的检测区域, 覆盖配置中的默认区域
+     * 
+     * @param stream_id 视频流ID
+     * @param config    检测区域
+     */
+    void set_zone(const int stream_id, const ZoneConfig &config);
+
+    /**
+     * @brief 运行指标 (帧数, 裁剪数, 各阶段耗时直方图等)
+     * 
+     * @return AlgoMetrics 
+     */
+    AlgoMetrics get_metrics() const;
+
+protected:
+    CascadeAlgo();
+    ~CascadeAlgo();
+
+    /**
+     * @brief 设置异步推理流控 (在途帧数上限, 过载丢帧策略, 有序输出)
+     *
+     * 提供 async_infer 的算法以 using 公开
+     * 
+     * @param config 流控配置
+     */
+    void set_flow_control(const FlowControlConfig &config);
+
+    /**
+     * @brief 累计丢帧数
+     * 
+     * @return uint64_t 
+     */
+    uint64_t dropped_frames() const;
+
+    std::unique_ptr<Cascade> cascade_;// 由各算法按自身阶段创建
+
+private:
+    friend class AlgoGroup;
+    friend class InferPipeline;
+    Cascade *cascade() const;// 供 AlgoGroup 共享整帧检测, InferPipeline 流水线推理
+};
+
+}// namespace gddi
@@ -0,0 +1,53 @@
+/**
+ * @file detection_record.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 检测结果录制/回放, 回放时不运行模型, 用于主机侧流程的可复现测试
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 开始录制, 之后加载的模型每次推理的检测结果 (按 视频流+帧ID) 写入文件
+ *
+ * 在当前推理后端 (见 set_infer_backend) 外层录制, 需在 load_models 前调用
+ *
+ * @param path 录制文件路径
+ * @return false 文件无法创建
+ */
+bool start_detection_record(const std::string &path);
+
+/**
+ * @brief 停止录制, 恢复录制前的推理后端并将缓冲的记录写入文件
+ *
+ * 仍在使用的模型继续录制, 最后一个模型释放时写入并关闭文件
+ */
+void stop_detection_record();
+
+/**
+ * @brief 开始回放, 之后加载的模型从录制文件读取检测结果, 不运行模型
+ *
+ * 按 模型路径+视频流+帧ID 匹配, 同一帧多次推理按顺序返回, 缺失时返回空结果
+ * 异步推理与真实后端一样在后端线程回调 (每个模型一个回放线程), 流控/有序输出路径与实际运行一致
+ *
+ * @param path    录制文件路径
+ * @param latency 模拟推理耗时(us), 在回放线程上等待
+ * @return false 文件无法读取或格式错误
+ */
+bool start_detection_replay(const std::string &path, const uint32_t latency = 0);
+
+/**
+ * @brief 停止回放, 恢复回放前的推理后端
+ */
+void stop_detection_replay();
+
+}// namespace gddi
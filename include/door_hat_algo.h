@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -20,9 +21,12 @@ namespace gddi {
 struct DoorHatAlgoConfig {
     float statistics_interval{3};   // 每隔N统计一次
     float statistics_threshold{0.5};// 统计阈值(检测到关们并且检测到防护帽时间占比)
+
+    MotionGateConfig motion_gate;// 运动门控 (画面静止时跳过未戴帽检测), 默认每帧检测
+    ZoneConfig zone;             // 检测区域 (各视频流默认), 默认全画面
 };
 
-class DoorHatAlgo {
+class DoorHatAlgo : public CascadeAlgo {
 public:
     DoorHatAlgo(const DoorHatAlgoConfig &config);
     ~DoorHatAlgo();
@@ -47,14 +51,21 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
-protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold);
+    /**
+     * @brief 多路同步推理接口
+     * 
+     * @param stream_id 视频流ID
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false 
+     */
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
 
 private:
     DoorHatAlgoConfig config_;
-
-    class DoorHatAlgoPrivate;
-    std::unique_ptr<DoorHatAlgoPrivate> private_;
 };
 
 }// namespace gddi
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -26,9 +27,12 @@ struct HelmetAlgoConfig {
 
     float statistics_interval{1};   // 每隔N统计一次
     float statistics_threshold{0.1};// 统计阈值(手与香烟重叠时间占比)
+
+    MotionGateConfig motion_gate;// 运动门控 (画面静止时跳过人员检测), 默认每帧检测
+    ZoneConfig zone;             // 检测区域 (各视频流默认), 默认全画面
 };
 
-class HelmetAlgo {
+class HelmetAlgo : public CascadeAlgo {
 public:
     HelmetAlgo(const HelmetAlgoConfig &config);
     ~HelmetAlgo();
@@ -53,14 +57,21 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
-protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result, const float threshold);
+    /**
+     * @brief 多路同步推理接口
+     * 
+     * @param stream_id 视频流ID
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false 
+     */
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
 
 private:
     HelmetAlgoConfig config_;
-
-    class HelmetAlgoPrivate;
-    std::unique_ptr<HelmetAlgoPrivate> private_;
 };
 
 }// namespace gddi
\ No newline at end of file
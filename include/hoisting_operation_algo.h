@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -19,9 +20,12 @@ struct HoistingOperationAlgoConfig {
 
     float statistics_interval{1};   // 每隔N秒统计一次
     float statistics_threshold{0.5};// 统计阈值
+
+    MotionGateConfig motion_gate;// 运动门控 (画面静止时跳过吊装物/人员检测), 默认每帧检测
+    ZoneConfig zone;             // 检测区域 (各视频流默认), 默认全画面
 };
 
-class HoistingOperationAlgo {
+class HoistingOperationAlgo : public CascadeAlgo {
 public:
     HoistingOperationAlgo(const HoistingOperationAlgoConfig &config);
     ~HoistingOperationAlgo();
@@ -31,15 +35,16 @@ public:
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
-protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels);
+    void async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
+    // 异步推理流控及丢帧数 (见 CascadeAlgo)
+    using CascadeAlgo::set_flow_control;
+    using CascadeAlgo::dropped_frames;
 
 private:
     HoistingOperationAlgoConfig config_;
-
-    class HoistingOperationAlgoPrivate;
-    std::unique_ptr<HoistingOperationAlgoPrivate> private_;
 };
 
 }// namespace gddi
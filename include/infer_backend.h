@@ -0,0 +1,76 @@
+/**
+ * @file infer_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 推理后端接口, 默认使用 gddeploy::InferAPI, 可替换为模拟后端在无加速卡的机器上运行主机侧流程
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "struct_def.h"
+#include <api/infer_api.h>
+#include <functional>
+#include <memory>
+
+namespace gddi {
+
+// 推理请求所属的帧, 供录制/回放等后端使用
+struct InferTag {
+    int stream_id;
+    int64_t image_id;
+};
+
+// 异步推理完成回调: 请求的 tag, 是否成功, 输出
+using InferBackendCallback = std::function<void(const InferTag &, bool, const gddeploy::PackagePtr &)>;
+
+class InferBackend {
+public:
+    virtual ~InferBackend() = default;
+
+    /**
+     * @brief 加载模型
+     */
+    virtual bool load(const ModelConfig &model) = 0;
+
+    /**
+     * @brief 同步推理
+     *
+     * @param tag         所属帧
+     * @param in_package  输入
+     * @param out_package 输出, 由调用者按输入数创建
+     */
+    virtual bool infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                            gddeploy::PackagePtr &out_package) = 0;
+
+    /**
+     * @brief 异步推理, 完成后在后端线程回调, 回调带回提交时的 tag
+     */
+    virtual void infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                             InferBackendCallback callback) = 0;
+
+    /**
+     * @brief 等待已提交的推理完成
+     */
+    virtual void wait_task_done() = 0;
+};
+
+using InferBackendPtr = std::shared_ptr<InferBackend>;
+using InferBackendCreator = std::function<InferBackendPtr(const ModelConfig &)>;
+
+/**
+ * @brief 设置进程级推理后端, 之后 load_models 加载的模型由 creator 创建
+ *
+ * 已加载的模型不受影响, creator 为空时恢复默认 (gddeploy::InferAPI)
+ */
+void set_infer_backend(InferBackendCreator creator);
+
+/**
+ * @brief 当前推理后端, 未设置时返回默认后端, 可用于在外层包装 (计时/录制等)
+ */
+InferBackendCreator get_infer_backend();
+
+}// namespace gddi
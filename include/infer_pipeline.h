@@ -0,0 +1,83 @@
+/**
+ * @file infer_pipeline.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 流水线推理, 逐帧调用的场景下保持多帧在途, 后一帧的检测与前一帧的裁剪检测重叠执行
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "cascade_algo.h"
+#include "struct_def.h"
+#include <memory>
+#include <vector>
+
+namespace gddi {
+
+class Cascade;
+
+struct PipelineResult {
+    int stream_id;
+    int64_t image_id;
+    cv::Mat image;
+    std::vector<AlgoObject> objects;
+    bool success;// 推理是否成功
+};
+
+class InferPipeline {
+public:
+    /**
+     * @brief 绑定算法, 算法需已加载模型且生命周期长于 InferPipeline
+     *
+     * 同一视频流的帧重叠执行时, 跟踪/统计按完成顺序更新 (与 async_infer 相同)
+     *
+     * @param algo  算法实例 (SparksCoverAlgo, WeldGloveAlgo ...)
+     * @param depth 最大在途帧数, 同时也是已提交未取出的帧数上限
+     */
+    InferPipeline(CascadeAlgo &algo, const size_t depth = 4) : InferPipeline(algo.cascade(), depth) {}
+    ~InferPipeline();
+
+    /**
+     * @brief 提交一帧, 在途帧数达到上限时阻塞等待最早的帧完成
+     *
+     * 已提交未取出的帧数达到 depth 时 (只提交不 poll), 等待最早的帧完成后丢弃其结果, 内存不随提交增长
+     *
+     * @param stream_id 视频流ID
+     * @param image_id  帧ID
+     * @param image     图像
+     */
+    void submit(const int stream_id, const int64_t image_id, const cv::Mat &image);
+    void submit(const int64_t image_id, const cv::Mat &image);
+
+    /**
+     * @brief 按提交顺序取出已完成的帧
+     *
+     * @param result 结果
+     * @param wait   最早的帧未完成时等待
+     * @return true
+     * @return false 无已提交的帧, 或 wait 为 false 且最早的帧未完成
+     */
+    bool poll(PipelineResult &result, const bool wait = false);
+
+    /**
+     * @brief 已提交未取出的帧数
+     */
+    size_t pending() const;
+
+    /**
+     * @brief 未及时取出被丢弃的结果数
+     */
+    uint64_t dropped() const;
+
+private:
+    InferPipeline(Cascade *cascade, const size_t depth);
+
+    class InferPipelinePrivate;
+    std::unique_ptr<InferPipelinePrivate> private_;
+};
+
+}// namespace gddi
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -20,9 +21,14 @@ namespace gddi {
 struct LightGloveAlgoConfig {
     float statistics_interval{3};   // 每隔N统计一次
     float statistics_threshold{0.5};// 统计阈值(检测到灯亮并且检测到手套时间占比)
+
+    DetectCacheConfig light_cache;// 灯光检测缓存, 默认每帧检测
+    CropCacheConfig crop_cache;   // 裁剪检测缓存 (按跟踪ID), 默认每帧检测
+    MotionGateConfig motion_gate; // 运动门控 (画面静止时跳过人员检测), 默认每帧检测
+    ZoneConfig zone;              // 检测区域 (各视频流默认), 默认全画面
 };
 
-class LightGloveAlgo {
+class LightGloveAlgo : public CascadeAlgo {
 public:
     LightGloveAlgo(const LightGloveAlgoConfig &config);
     ~LightGloveAlgo();
@@ -47,15 +53,21 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
-protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels, const float threshold);
+    /**
+     * @brief 多路同步推理接口
+     * 
+     * @param stream_id 视频流ID
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false 
+     */
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
 
 private:
     LightGloveAlgoConfig config_;
-
-    class LightGloveAlgoPrivate;
-    std::unique_ptr<LightGloveAlgoPrivate> private_;
 };
 
 }// namespace gddi
\ No newline at end of file
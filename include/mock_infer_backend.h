@@ -0,0 +1,62 @@
+/**
+ * @file mock_infer_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 模拟推理后端, 按脚本或随机生成检测结果, 可配置推理耗时
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+struct MockDetection {
+    int class_id;
+    std::string label;
+    float score;
+    cv::Rect rect;// 输入图像 (整帧或裁剪区域) 坐标
+};
+
+// 脚本: (调用序号, 批内序号) -> 检测结果
+using MockScript = std::function<std::vector<MockDetection>(const uint64_t, const size_t)>;
+
+struct MockInferBackendConfig {
+    uint32_t latency{0};     // 单次推理耗时(us)
+    uint32_t item_latency{0};// 批内每个输入的额外耗时(us)
+
+    MockScript script;// 检测脚本, 为空时随机生成
+
+    // 以下为随机生成参数
+    std::vector<std::string> labels;// 生成标签, 为空时使用 ModelConfig::labels
+    uint32_t max_objects{4};        // 每个输入最多目标数
+    cv::Size input_size{1920, 1080};// 目标框坐标范围 (模拟后端无法获取输入尺寸)
+    uint32_t seed{0};               // 随机种子, 相同种子+调用顺序结果一致
+};
+
+class MockInferBackend : public InferBackend {
+public:
+    MockInferBackend(const MockInferBackendConfig &config);
+    ~MockInferBackend();
+
+    bool load(const ModelConfig &model) override;
+    bool infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override;
+    void infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     InferBackendCallback callback) override;
+    void wait_task_done() override;
+
+private:
+    MockInferBackendConfig config_;
+
+    class MockInferBackendPrivate;
+    std::unique_ptr<MockInferBackendPrivate> private_;
+};
+
+}// namespace gddi
@@ -0,0 +1,36 @@
+/**
+ * @file pipeline_trace.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 流水线时间线追踪, 记录每帧各阶段起止时间, 导出 Chrome trace (chrome://tracing, Perfetto)
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace gddi {
+
+/**
+ * @brief 开始追踪, 所有算法实例的阶段 (图像转换/推理/解析/跟踪/重叠合并/统计) 写入环形缓冲区
+ *
+ * 缓冲区写满后覆盖最早的记录, 未开始追踪时各阶段只做一次原子读取
+ *
+ * @param capacity 缓冲区记录数
+ */
+void start_pipeline_trace(const size_t capacity = 1 << 16);
+
+/**
+ * @brief 停止追踪, 将缓冲区内记录按 Chrome trace JSON 格式写入文件
+ *
+ * @param path 输出文件路径
+ * @return false 文件无法创建
+ */
+bool stop_pipeline_trace(const std::string &path);
+
+}// namespace gddi
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -26,9 +27,13 @@ struct PlayPhoneAlgoConfig {
 
     float statistics_interval{3};    // 每隔N统计一次
     float statistics_threshold{0.5f};// 统计阈值(手与手机重叠时间占比)
+
+    CropCacheConfig crop_cache;  // 裁剪检测缓存 (按跟踪ID), 默认每帧检测
+    MotionGateConfig motion_gate;// 运动门控 (画面静止时跳过人员检测), 默认每帧检测
+    ZoneConfig zone;             // 检测区域 (各视频流默认), 默认全画面
 };
 
-class PlayPhoneAlgo {
+class PlayPhoneAlgo : public CascadeAlgo {
 public:
     PlayPhoneAlgo(const PlayPhoneAlgoConfig &config);
     ~PlayPhoneAlgo();
@@ -62,14 +67,35 @@ public:
      */
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
-protected:
-    std::vector<AlgoObject> parse_infer_result(const gddeploy::InferResult &infer_result);
+    /**
+     * @brief 多路异步推理接口, 各路状态独立, 共享已加载模型
+     * 
+     * @param stream_id 视频流ID
+     * @param image_id  帧ID
+     * @param image     图像
+     * @param callback  回调
+     */
+    void async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image, InferCallback callback);
+
+    /**
+     * @brief 多路同步推理接口
+     * 
+     * @param stream_id 视频流ID
+     * @param image_id 
+     * @param image 
+     * @param objects 
+     * @return true 
+     * @return false 
+     */
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
+    // 异步推理流控及丢帧数 (见 CascadeAlgo)
+    using CascadeAlgo::set_flow_control;
+    using CascadeAlgo::dropped_frames;
 
 private:
     PlayPhoneAlgoConfig config_;
-
-    class PlayPhoneAlgoPrivate;
-    std::unique_ptr<PlayPhoneAlgoPrivate> private_;
 };
 
 }// namespace gddi
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cascade_algo.h"
 #include "struct_def.h"
 #include <api/infer_api.h>
 #include <core/result_def.h>
@@ -9,15 +10,21 @@
 
 namespace gddi {
 
+struct CascadeContext;
+
 struct SafetyBeltAlgoConfig {
     uint32_t delay_time{3};    // 延迟时间
     float light_threshold{0.3};// 灯光统计阈值
 
     uint32_t statistics_time{5};     // 统计时间
     float safety_belt_threshold{0.5};// 安全带统计阈值
+
+    DetectCacheConfig light_cache;// 灯光检测缓存, 默认每帧检测
+    MotionGateConfig motion_gate; // 运动门控 (画面静止时跳过人员检测), 默认每帧检测
+    ZoneConfig zone;              // 检测区域 (各视频流默认), 默认全画面
 };
 
-class SafetyBeltAlgo {
+class SafetyBeltAlgo : public CascadeAlgo {
 public:
     SafetyBeltAlgo(const SafetyBeltAlgoConfig &config);
     ~SafetyBeltAlgo();
@@ -27,9 +34,20 @@ public:
     void async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
     bool sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &objects);
 
+    void async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
+    // 同时清除安全带/灯光统计
+    void release_stream(const int stream_id);
+
+    // 异步推理流控及丢帧数 (见 CascadeAlgo)
+    using CascadeAlgo::set_flow_control;
+    using CascadeAlgo::dropped_frames;
+
 protected:
-    std::vector<AlgoObject> filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                const std::set<std::string> &labels);
+    void update_safety_belt(CascadeContext &context);
+    void update_light(CascadeContext &context);
 
 private:
     SafetyBeltAlgoConfig config_;
@@ -16,6 +16,8 @@
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <vector>
 
 
 namespace gddi {
@@ -45,4 +47,105 @@ struct AlgoObject {
 
 using InferCallback = std::function<void(const int64_t, const cv::Mat &, const std::vector<AlgoObject> &)>;
 
+enum class OverflowPolicy {
+    kBlock,     // 阻塞等待
+    kDropOldest,// 丢弃最早的排队帧
+    kDropNewest,// 丢弃新帧
+    kKeepNth,   // 过载时每N帧保留一帧, 排队已满时丢弃最早的排队帧
+};
+
+// 异步推理流控, 限制在途帧数, 过载时按策略丢帧
+struct FlowControlConfig {
+    uint32_t max_inflight{0};// 最大在途帧数 (已提交推理), 0 为不限制
+    uint32_t max_queue{0};   // 在途已满时最大排队帧数
+    OverflowPolicy policy{OverflowPolicy::kBlock};
+    uint32_t keep_interval{2};// kKeepNth 每N帧保留一帧
+
+    std::function<void(const int64_t)> drop_callback;// 丢帧回调 (帧ID)
+
+    bool ordered_delivery{false};  // 按帧ID顺序回调 (每路视频流独立排序)
+    uint32_t reorder_timeout{1000};// 等待缺失帧的超时时间(ms), 超时后跳过该帧
+};
+
+// 整帧检测缓存 (如指示灯状态很少变化), 缓存有效时跳过推理, 使用上次检测结果
+struct DetectCacheConfig {
+    uint32_t max_frames{0};  // 每N帧重新检测, 0/1 为不缓存
+    uint32_t max_interval{0};// 距上次检测超过T毫秒时重新检测, 0 为不限制
+    float probe_threshold{0};// 最近检出目标框内像素均值变化超过阈值(0~255)时重新检测, 0 为不探测
+};
+
+// 裁剪检测缓存, 按跟踪ID复用结果稳定的目标, 跳过裁剪推理
+struct CropCacheConfig {
+    uint32_t stable_count{0};   // 连续N次检测结果 (标签) 一致后开始复用, 0 为不缓存
+    uint32_t recheck_frames{25};// 复用N帧后重新检测, 0 为不限制
+    float max_shift{0.2};       // 目标框中心偏移超过框宽/高的比例时重新检测
+    float max_scale{0.2};       // 目标框宽/高变化超过比例时重新检测
+};
+
+// 运动门控, 画面相对上次检测无变化时跳过标记的整帧检测 (一般为人员检测), 复用上次结果, 跟踪只做预测
+struct MotionGateConfig {
+    bool enable{false};
+    uint32_t width{160};        // 帧差图宽度 (等比缩小后的灰度图)
+    uint8_t pixel_threshold{15};// 像素灰度变化阈值
+    float area_threshold{0.002};// 变化像素占比超过阈值视为运动 (灵敏度)
+    uint32_t max_skip{25};      // 最多连续跳过帧数, 0 为不限制
+};
+
+enum class ZoneAnchor {
+    kBottomCenter,// 目标框底边中点 (站立位置)
+    kCenter,      // 目标框中心
+};
+
+// 检测区域, 多边形顶点为 0~1 归一化坐标, 区域外目标在首阶段检测后剔除, 不再进入裁剪检测
+struct ZoneConfig {
+    std::vector<std::vector<cv::Point2f>> include;// 检测区域, 为空则为全画面
+    std::vector<std::vector<cv::Point2f>> exclude;// 屏蔽区域, 优先于检测区域
+    ZoneAnchor anchor{ZoneAnchor::kBottomCenter}; // 按目标框锚点判断是否在区域内
+};
+
+constexpr size_t kLatencyBuckets = 32;
+
+// 耗时直方图快照, 桶 0 为 <1us, 桶 i 为 [2^(i-1), 2^i) us
+struct LatencyHistogram {
+    uint64_t count{0};
+    uint64_t total_us{0};
+    uint64_t max_us{0};
+    std::vector<uint64_t> buckets;
+
+    double mean_us() const { return count > 0 ? (double)total_us / count : 0; }
+
+    // 分位数 (按桶上界估算, 不超过最大值), ratio 取 0~1
+    uint64_t percentile_us(const double ratio) const {
+        uint64_t target = (uint64_t)(ratio * count + 0.5);
+        uint64_t accumulated = 0;
+        for (size_t i = 0; i < buckets.size(); i++) {
+            accumulated += buckets[i];
+            if (accumulated >= std::max<uint64_t>(target, 1)) { return std::min<uint64_t>(1ull << i, max_us); }
+        }
+        return max_us;
+    }
+};
+
+// 算法运行指标快照, 自实例创建起累计
+struct AlgoMetrics {
+    uint64_t frames{0};           // 提交帧数
+    uint64_t failed_frames{0};    // 推理失败帧数
+    uint64_t dropped_frames{0};   // 流控丢帧数
+    uint64_t callbacks{0};        // 异步回调数
+    uint64_t crops{0};            // 裁剪检测输入数
+    uint64_t truncated_crops{0};  // 超出 max_crop_number 被截断的目标数
+    uint64_t cached_detections{0};// 命中缓存跳过的整帧检测数 (见 DetectCacheConfig)
+    uint64_t cached_crops{0};     // 命中缓存跳过的裁剪检测输入数 (见 CropCacheConfig)
+    uint64_t motion_skipped{0};   // 画面静止跳过门控检测的帧数 (见 MotionGateConfig)
+    uint64_t zone_filtered{0};    // 检测区域外剔除的目标数 (见 ZoneConfig)
+
+    LatencyHistogram frame;      // 单帧总耗时 (异步含排队)
+    LatencyHistogram convert;    // 图像转换 (整帧/裁剪 surface)
+    LatencyHistogram parse;      // 推理结果解析 (不含裁剪结果合并)
+    LatencyHistogram track;      // 目标跟踪
+    LatencyHistogram cover_merge;// 多目标重叠合并
+    LatencyHistogram statistic;  // 时序统计
+    std::map<std::string, LatencyHistogram> models;// 各模型推理 (提交到结果返回), 按模型名称
+};
+
 }// namespace gddi
\ No newline at end of file
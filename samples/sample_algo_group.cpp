@@ -0,0 +1,63 @@
+#include "algo_group.h"
+#include "safety_belt_algo.h"
+#include "smoke_algo.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+int main() {
+    auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(gddi::SmokeAlgoConfig{});
+    auto safety_belt_algo = std::make_unique<gddi::SafetyBeltAlgo>(gddi::SafetyBeltAlgoConfig{});
+
+    // 行人模型路径+阈值相同, 组内每帧只检测一次
+    std::string video_path = "../videos/safety_belt.mp4";
+    std::vector<gddi::ModelConfig> smoke_models = {
+        {"person", "../models/person.gdd", "../models/license_person.gdd", 0.3},
+        {"smoke", "../models/smoke.gdd", "../models/license_smoke.gdd", 0.3}};
+    std::vector<gddi::ModelConfig> safety_belt_models = {
+        {"person", "../models/person.gdd", "../models/license_person.gdd", 0.3, {"person"}},
+        {"safety_belt", "../models/safety_belt.gdd", "../models/license_safety_belt.gdd", 0.3, {"safety_belt"}},
+        {"safety_belt_light",
+         "../models/safety_belt_light.gdd",
+         "../models/license_safety_belt_light.gdd",
+         0.3,
+         {"light_on"}}};
+
+    if (!smoke_algo->load_models(smoke_models) || !safety_belt_algo->load_models(safety_belt_models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    gddi::AlgoGroup algo_group;
+    algo_group.add_algo("smoke", *smoke_algo);
+    algo_group.add_algo("safety_belt", *safety_belt_algo);
+
+    // 读取视频, 进行推理
+    auto image = cv::VideoCapture(video_path);
+    if (!image.isOpened()) {
+        printf("Failed to open video: %s\n", video_path.c_str());
+        return -1;
+    }
+
+    int64_t frame_index = 0;
+    while (true) {
+        cv::Mat frame;
+        image.read(frame);
+        if (frame.empty()) { break; }
+
+        std::map<std::string, std::vector<gddi::AlgoObject>> objects;
+        algo_group.sync_infer(0, frame_index, frame, objects);
+
+        for (const auto &[name, algo_objects] : objects) {
+            if (algo_objects.empty()) { continue; }
+            printf("=============== Frame: %ld, Algo: %s, Objects: %ld\n", frame_index, name.c_str(),
+                   algo_objects.size());
+        }
+
+        frame_index++;
+    }
+
+    printf("Finished\n");
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "infer_pipeline.h"
+#include "sparks_cover_algo.h"
+#include <cstdint>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+int main() {
+    gddi::SparksCoverAlgoConfig config;
+    auto sparks_cover_algo = std::make_unique<gddi::SparksCoverAlgo>(config);
+
+    std::string video_path = "../videos/sparks_cover-1.mp4";
+    std::vector<gddi::ModelConfig> models = {
+        {"light", "../models/sparks.gdd", "../models/license_sparks.gdd", 0.3, {"sparks"}},
+        {"person", "../models/person.gdd", "../models/license_person.gdd", 0.6, {"person"}, 4.0f},
+        {"cover", "../models/cover.gdd", "../models/license_cover.gdd", 0.3, {"cover"}, 1.5f}};
+
+    if (!sparks_cover_algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    // 最多 4 帧在途, 结果按提交顺序取出
+    gddi::InferPipeline pipeline(*sparks_cover_algo, 4);
+
+    auto print_result = [](const gddi::PipelineResult &result) {
+        if (!result.objects.empty()) {
+            printf("=============== Frame: %ld, Objects: %ld\n", result.image_id, result.objects.size());
+        }
+    };
+
+    // 读取视频, 进行推理
+    auto image = cv::VideoCapture(video_path);
+    if (!image.isOpened()) {
+        printf("Failed to open video: %s\n", video_path.c_str());
+        return -1;
+    }
+
+    int64_t frame_index = 0;
+    gddi::PipelineResult result;
+    while (true) {
+        cv::Mat frame;
+        image.read(frame);
+        if (frame.empty()) { break; }
+
+        pipeline.submit(frame_index++, frame);
+        while (pipeline.poll(result)) { print_result(result); }
+    }
+
+    // 取出剩余帧
+    while (pipeline.poll(result, true)) { print_result(result); }
+
+    printf("Finished\n");
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "mock_infer_backend.h"
+#include "smoke_algo.h"
+#include <chrono>
+
+int main() {
+    // 模拟后端, 无需加速卡即可运行跟踪/裁剪/重叠/统计等主机侧流程
+    gddi::set_infer_backend([](const gddi::ModelConfig &model) {
+        gddi::MockInferBackendConfig config;
+        config.latency = 10000;
+        config.item_latency = 1000;
+        if (model.name == "smoke") {
+            config.labels = {"hand", "smoke"};
+            config.input_size = cv::Size{256, 512};
+        }
+        return std::make_shared<gddi::MockInferBackend>(config);
+    });
+
+    gddi::SmokeAlgoConfig config;
+    auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(config);
+
+    std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "license_person.gdd", 0.3},
+                                             {"smoke", "smoke.gdd", "license_smoke.gdd", 0.3}};
+
+    if (!smoke_algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    cv::Mat frame(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t object_number = 0;
+    for (int64_t frame_index = 0; frame_index < 1000; frame_index++) {
+        std::vector<gddi::AlgoObject> objects;
+        smoke_algo->sync_infer(frame_index, frame, objects);
+        object_number += objects.size();
+    }
+
+    printf("Frames: 1000, Objects: %ld, Cost: %ld ms\n", object_number,
+           std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "mock_infer_backend.h"
+#include "smoke_algo.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// 模拟后端, 指定帧的推理迟迟不返回 (卡住), 直到手动放行
+class StallBackend : public gddi::InferBackend {
+public:
+    StallBackend(const gddi::InferBackendPtr &backend, const int64_t stall_image_id)
+        : backend_(backend), stall_image_id_(stall_image_id) {}
+
+    bool load(const gddi::ModelConfig &model) override { return backend_->load(model); }
+
+    bool infer_sync(const gddi::InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override {
+        return backend_->infer_sync(tag, in_package, out_package);
+    }
+
+    void infer_async(const gddi::InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     gddi::InferBackendCallback callback) override {
+        if (tag.image_id != stall_image_id_) { return backend_->infer_async(tag, in_package, callback); }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stalled_.emplace_back(tag, in_package, callback);
+    }
+
+    void wait_task_done() override { backend_->wait_task_done(); }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &item : stalled_) {
+            backend_->infer_async(std::get<0>(item), std::get<1>(item), std::get<2>(item));
+        }
+        stalled_.clear();
+    }
+
+private:
+    gddi::InferBackendPtr backend_;
+    int64_t stall_image_id_;
+
+    std::mutex mutex_;
+    std::vector<std::tuple<gddi::InferTag, gddeploy::PackagePtr, gddi::InferBackendCallback>> stalled_;
+};
+
+// 最后几帧中的一帧卡住: 之后不再提交新帧, 其后已完成的帧仍需按顺序交付, 卡住的帧超时后跳过
+constexpr int64_t kFrameNumber = 10;
+constexpr int64_t kStallImageId = kFrameNumber - 2;
+
+int main() {
+    std::vector<std::shared_ptr<StallBackend>> backends;
+    gddi::set_infer_backend([&backends](const gddi::ModelConfig &model) -> gddi::InferBackendPtr {
+        gddi::MockInferBackendConfig config;
+        config.latency = 1000;
+        if (model.name == "smoke") { config.labels = {"hand", "smoke"}; }
+        auto backend = std::make_shared<StallBackend>(std::make_shared<gddi::MockInferBackend>(config), kStallImageId);
+        backends.emplace_back(backend);
+        return backend;
+    });
+
+    gddi::SmokeAlgoConfig config;
+    auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(config);
+
+    std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "license_person.gdd", 0.3},
+                                             {"smoke", "smoke.gdd", "license_smoke.gdd", 0.3}};
+    if (!smoke_algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    gddi::FlowControlConfig flow_control;
+    flow_control.ordered_delivery = true;
+    flow_control.reorder_timeout = 200;
+    smoke_algo->set_flow_control(flow_control);
+
+    std::mutex mutex;
+    std::vector<int64_t> delivered;
+    cv::Mat frame(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+    for (int64_t frame_index = 0; frame_index < kFrameNumber; frame_index++) {
+        smoke_algo->async_infer(frame_index, frame,
+                                [&](const int64_t image_id, const cv::Mat &, const std::vector<gddi::AlgoObject> &) {
+                                    std::lock_guard<std::mutex> lock(mutex);
+                                    delivered.emplace_back(image_id);
+                                });
+    }
+
+    // 不再提交新帧, 等待超过超时时间
+    std::this_thread::sleep_for(std::chrono::milliseconds(flow_control.reorder_timeout * 3));
+
+    bool passed = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<int64_t> expected;
+        for (int64_t image_id = 0; image_id < kFrameNumber; image_id++) {
+            if (image_id != kStallImageId) { expected.emplace_back(image_id); }
+        }
+        passed = delivered == expected;
+        printf("Delivered %ld/%ld frames after stall, expected %ld\n", delivered.size(), kFrameNumber,
+               expected.size());
+    }
+
+    // 放行卡住的帧, 其结果已超时被丢弃
+    for (auto &backend : backends) { backend->resume(); }
+    smoke_algo.reset();
+    gddi::set_infer_backend(nullptr);
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
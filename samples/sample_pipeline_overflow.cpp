@@ -0,0 +1,53 @@
+#include "infer_pipeline.h"
+#include "mock_infer_backend.h"
+#include "smoke_algo.h"
+
+// 只提交不取出结果: 已提交未取出的帧数不超过 depth, 超出部分丢弃最早的结果
+constexpr size_t kDepth = 4;
+constexpr int64_t kFrameNumber = kDepth * 8;
+
+int main() {
+    gddi::set_infer_backend([](const gddi::ModelConfig &model) -> gddi::InferBackendPtr {
+        gddi::MockInferBackendConfig config;
+        config.latency = 1000;
+        if (model.name == "smoke") { config.labels = {"hand", "smoke"}; }
+        return std::make_shared<gddi::MockInferBackend>(config);
+    });
+
+    gddi::SmokeAlgoConfig config;
+    auto smoke_algo = std::make_unique<gddi::SmokeAlgo>(config);
+
+    std::vector<gddi::ModelConfig> models = {{"person", "person.gdd", "license_person.gdd", 0.3},
+                                             {"smoke", "smoke.gdd", "license_smoke.gdd", 0.3}};
+    if (!smoke_algo->load_models(models)) {
+        printf("Failed to load models\n");
+        return -1;
+    }
+
+    bool passed = true;
+    {
+        gddi::InferPipeline pipeline(*smoke_algo, kDepth);
+
+        cv::Mat frame(1080, 1920, CV_8UC3, cv::Scalar(0, 0, 0));
+        for (int64_t frame_index = 0; frame_index < kFrameNumber; frame_index++) {
+            pipeline.submit(frame_index, frame);
+            if (pipeline.pending() > kDepth) { passed = false; }
+        }
+
+        // 剩余的是最后 depth 帧, 按提交顺序取出
+        gddi::PipelineResult result;
+        int64_t image_id = kFrameNumber - kDepth;
+        while (pipeline.poll(result, true)) {
+            if (result.image_id != image_id++) { passed = false; }
+        }
+
+        passed = passed && image_id == kFrameNumber && pipeline.dropped() == kFrameNumber - kDepth;
+        printf("Submitted: %ld, Dropped: %ld\n", kFrameNumber, pipeline.dropped());
+    }
+
+    smoke_algo.reset();
+    gddi::set_infer_backend(nullptr);
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
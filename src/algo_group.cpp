@@ -0,0 +1,68 @@
+#include "algo_group.h"
+#include "cascade/cascade.h"
+#include <mutex>
+
+namespace gddi {
+
+class AlgoGroup::AlgoGroupPrivate {
+public:
+    std::vector<std::pair<std::string, Cascade *>> cascades;
+};
+
+// 单帧各算法结果汇总
+struct GroupResult {
+    std::mutex mutex;
+    size_t remain_number{0};
+    std::map<std::string, std::vector<AlgoObject>> objects;
+};
+
+AlgoGroup::AlgoGroup() { private_ = std::make_unique<AlgoGroupPrivate>(); }
+
+AlgoGroup::~AlgoGroup() = default;
+
+void AlgoGroup::add_cascade(const std::string &name, Cascade *cascade) {
+    private_->cascades.emplace_back(name, cascade);
+}
+
+void AlgoGroup::async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                            GroupInferCallback infer_callback) {
+    if (private_->cascades.empty()) {
+        if (infer_callback) { infer_callback(image_id, image, {}); }
+        return;
+    }
+
+    // 各算法共享同一帧上下文, 相同的整帧检测只推理一次
+    auto frame = std::make_shared<FrameContext>(image_id, image);
+    auto result = std::make_shared<GroupResult>();
+    result->remain_number = private_->cascades.size();
+
+    for (const auto &item : private_->cascades) {
+        auto name = item.first;
+        item.second->async_infer(
+            stream_id, frame,
+            [result, name, infer_callback](const int64_t image_id, const cv::Mat &image,
+                                           const std::vector<AlgoObject> &objects) {
+                std::unique_lock<std::mutex> lock(result->mutex);
+                result->objects[name] = objects;
+                if (--result->remain_number > 0) { return; }
+                lock.unlock();
+
+                if (infer_callback) { infer_callback(image_id, image, result->objects); }
+            });
+    }
+}
+
+bool AlgoGroup::sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                           std::map<std::string, std::vector<AlgoObject>> &objects) {
+    auto frame = std::make_shared<FrameContext>(image_id, image);
+
+    bool success = true;
+    objects.clear();
+    for (const auto &item : private_->cascades) {
+        if (!item.second->sync_infer(stream_id, frame, objects[item.first])) { success = false; }
+    }
+
+    return success;
+}
+
+}// namespace gddi
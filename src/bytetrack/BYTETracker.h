@@ -1,14 +1,17 @@
 #pragma once
 
 #include "STrack.h"
+#include "bboxIous.h"
+#include <memory>
+
+struct lapjv_workspace;
 
 struct Object {
     int target_id;
     int class_id;
     float prob;
     cv::Rect_<float> rect;
-    std::string label_name;
-    std::array<int, 4> color;
+    int label_id; // STrack::label_to_id
 };
 
 class BYTETracker {
@@ -17,23 +20,31 @@ public:
                 const int track_buffer = 30);
 	~BYTETracker();
 
-	vector<STrack> update(const vector<Object>& objects);
+	// The returned tracks stay valid until the next update/predict call
+	const vector<STrack> &update(const vector<Object>& objects);
+	const vector<STrack> &predict(); // no detections (static frame), Kalman prediction only
 	Scalar get_color(int idx);
 
 private:
-	vector<STrack*> joint_stracks(vector<STrack*> &tlista, vector<STrack> &tlistb);
-	vector<STrack> joint_stracks(vector<STrack> &tlista, vector<STrack> &tlistb);
+	int next_id();
+	void remove_duplicate_stracks();
+	void remove_oldest_lost_strack();
+
+	// Batched Kalman predict of stracks[indices], and update of the tracks in matches
+	void multi_predict(const vector<int> &indices);
+	void update_matches(const vector<int> &track_indices, const vector<STrack> &dets);
 
-	vector<STrack> sub_stracks(vector<STrack> &tlista, vector<STrack> &tlistb);
-	void remove_duplicate_stracks(vector<STrack> &resa, vector<STrack> &resb, vector<STrack> &stracksa, vector<STrack> &stracksb);
+	void gather_tlbrs(const vector<STrack> &stracks, const vector<int> &indices, BOX_SOA &tlbrs);
+	void gather_tlbrs(const vector<STrack> &stracks, BOX_SOA &tlbrs);
 
-	void linear_assignment(vector<vector<float> > &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
-		vector<vector<int> > &matches, vector<int> &unmatched_a, vector<int> &unmatched_b);
-	vector<vector<float> > iou_distance(vector<STrack*> &atracks, vector<STrack> &btracks, int &dist_size, int &dist_size_size);
-	vector<vector<float> > iou_distance(vector<STrack> &atracks, vector<STrack> &btracks);
-	vector<vector<float> > ious(vector<vector<float> > &atlbrs, vector<vector<float> > &btlbrs);
+	// Cost matrices are row-major (dist_size x dist_size_size) in one contiguous buffer
+	void linear_assignment(const vector<float> &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
+		vector<MATCH_DATA> &matches, vector<int> &unmatched_a, vector<int> &unmatched_b);
+	void iou_distance(const BOX_SOA &atlbrs, const BOX_SOA &btlbrs, vector<float> &cost_matrix,
+		int &dist_size, int &dist_size_size);
+	void ious(const BOX_SOA &atlbrs, const BOX_SOA &btlbrs, vector<float> &ious);
 
-	double lapjv(const vector<vector<float> > &cost, vector<int> &rowsol, vector<int> &colsol, 
+	double lapjv(const vector<float> &cost, int n_rows, int n_cols, vector<int> &rowsol, vector<int> &colsol,
 		bool extend_cost = false, float cost_limit = LONG_MAX, bool return_cost = true);
 
 private:
@@ -43,9 +54,38 @@ private:
     float match_thresh;
     int frame_id;
     int max_time_lost;
+    int track_id_count; // last track id handed out by this tracker
 
-    vector<STrack> tracked_stracks;
-    vector<STrack> lost_stracks;
-    vector<STrack> removed_stracks;
+    // All live tracks (Tracked/Lost). State transitions only change flags, removed tracks are
+    // compacted away at the end of each update, so tracks are never copied between pools.
+    // Their Kalman states are slots in kalman_filter, released together with the track.
+    vector<STrack> stracks;
     byte_kalman::KalmanFilter kalman_filter;
-};
\ No newline at end of file
+
+    // Per-frame scratch buffers, cleared but not freed between frames
+    vector<STrack> detections;
+    vector<STrack> detections_low;
+    vector<int> unconfirmed;
+    vector<int> tracked_stracks;
+    vector<int> lost_stracks;
+    vector<int> strack_pool;
+    vector<int> r_tracked_stracks;
+    vector<int> u_track;
+    vector<int> u_detection;
+    vector<int> u_detection_high;
+    vector<MATCH_DATA> matches;
+    BOX_SOA atlbrs;
+    BOX_SOA btlbrs;
+    vector<STrack> output_stracks;
+    vector<int> kalman_slots;
+    vector<DETECTBOX> kalman_measurements;
+
+    // Cost matrix and LAPJV buffers, reused across frames
+    vector<float> dists;
+    vector<float> cost_extended;
+    vector<int> rowsol;
+    vector<int> colsol;
+    vector<int> x_c;
+    vector<int> y_c;
+    std::unique_ptr<lapjv_workspace> lapjv_ws;
+};
@@ -1,55 +1,46 @@
 #include "STrack.h"
+#include <deque>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
-STrack::STrack(vector<float> tlwh_, float score, int class_id, int target_id,  std::string label_name, std::array<int, 4> color)
+namespace
 {
-	_tlwh.resize(4);
-	_tlwh.assign(tlwh_.begin(), tlwh_.end());
+	std::mutex label_mutex;
+	std::unordered_map<std::string, int> label_ids;
+	std::deque<std::string> label_names; // deque keeps references valid while growing
+}
+
+STrack::STrack(const STRACK_BOX &tlwh_, float score, int class_id, int target_id, int label_id)
+{
+	_tlwh = tlwh_;
 
 	is_activated = false;
 	track_id = 0;
 	state = TrackState::New;
-	
-	tlwh.resize(4);
-	tlbr.resize(4);
 
-	static_tlwh();
+	tlwh = _tlwh;
 	static_tlbr();
 	frame_id = 0;
 	tracklet_len = 0;
 	this->score = score;
 	this->class_id = class_id;
 	this->target_id = target_id;
-	this->label_name = label_name;
-	this->color = color;
+	this->label_id = label_id;
 	start_frame = 0;
+	kalman_slot = -1;
 }
 
-STrack::~STrack()
-{
-}
-
-void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
+void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id, int track_id)
 {
-	this->kalman_filter = kalman_filter;
-	this->track_id = this->next_id();
+	this->track_id = track_id;
 
-	vector<float> _tlwh_tmp(4);
-	_tlwh_tmp[0] = this->_tlwh[0];
-	_tlwh_tmp[1] = this->_tlwh[1];
-	_tlwh_tmp[2] = this->_tlwh[2];
-	_tlwh_tmp[3] = this->_tlwh[3];
-	vector<float> xyah = tlwh_to_xyah(_tlwh_tmp);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-	auto mc = this->kalman_filter.initiate(xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
+	STRACK_BOX xyah = tlwh_to_xyah(this->_tlwh);
+	DETECTBOX xyah_box(xyah[0], xyah[1], xyah[2], xyah[3]);
+	this->kalman_slot = kalman_filter.alloc_slot();
+	kalman_filter.initiate(this->kalman_slot, xyah_box);
 
-	static_tlwh();
+	static_tlwh(kalman_filter);
 	static_tlbr();
 
 	this->tracklet_len = 0;
@@ -63,111 +54,75 @@ void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
 	this->start_frame = frame_id;
 }
 
-void STrack::re_activate(STrack &new_track, int frame_id, bool new_id)
+void STrack::re_activate(const STrack &new_track, int frame_id, int new_id)
 {
-	vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-	auto mc = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
-
-	static_tlwh();
-	static_tlbr();
-
 	this->tracklet_len = 0;
 	this->state = TrackState::Tracked;
 	this->is_activated = true;
 	this->frame_id = frame_id;
 	this->target_id = new_track.target_id;
 	this->class_id = new_track.class_id;
-	this->label_name= new_track.label_name;
-	this->color = new_track.color;
+	this->label_id = new_track.label_id;
 	this->score = new_track.score;
 	if (new_id)
-		this->track_id = next_id();
+		this->track_id = new_id;
 }
 
-void STrack::update(STrack &new_track, int frame_id)
+void STrack::update(const STrack &new_track, int frame_id)
 {
 	this->frame_id = frame_id;
 	this->tracklet_len++;
 
-	vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-
-	auto mc = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
-
-	static_tlwh();
-	static_tlbr();
-
 	this->state = TrackState::Tracked;
 	this->is_activated = true;
 
 	this->target_id = new_track.target_id;
 	this->class_id = new_track.class_id;
-	this->label_name = new_track.label_name;
-	this->color = new_track.color;
+	this->label_id = new_track.label_id;
 	this->score = new_track.score;
 }
 
-void STrack::static_tlwh()
+void STrack::static_tlwh(const byte_kalman::KalmanFilter &kalman_filter)
 {
 	if (this->state == TrackState::New)
 	{
-		tlwh[0] = _tlwh[0];
-		tlwh[1] = _tlwh[1];
-		tlwh[2] = _tlwh[2];
-		tlwh[3] = _tlwh[3];
+		tlwh = _tlwh;
 		return;
 	}
 
-	tlwh[0] = mean[0];
-	tlwh[1] = mean[1];
-	tlwh[2] = mean[2];
-	tlwh[3] = mean[3];
-
-	tlwh[2] *= tlwh[3];
-	tlwh[0] -= tlwh[2] / 2;
-	tlwh[1] -= tlwh[3] / 2;
+	tlwh[2] = kalman_filter.mean(kalman_slot, 2) * kalman_filter.mean(kalman_slot, 3);
+	tlwh[3] = kalman_filter.mean(kalman_slot, 3);
+	tlwh[0] = kalman_filter.mean(kalman_slot, 0) - tlwh[2] / 2;
+	tlwh[1] = kalman_filter.mean(kalman_slot, 1) - tlwh[3] / 2;
 }
 
 void STrack::static_tlbr()
 {
-	tlbr.clear();
-	tlbr.assign(tlwh.begin(), tlwh.end());
+	tlbr = tlwh;
 	tlbr[2] += tlbr[0];
 	tlbr[3] += tlbr[1];
 }
 
-vector<float> STrack::tlwh_to_xyah(vector<float> tlwh_tmp)
+STRACK_BOX STrack::tlwh_to_xyah(const STRACK_BOX &tlwh_tmp)
 {
-	vector<float> tlwh_output = tlwh_tmp;
+	STRACK_BOX tlwh_output = tlwh_tmp;
 	tlwh_output[0] += tlwh_output[2] / 2;
 	tlwh_output[1] += tlwh_output[3] / 2;
 	tlwh_output[2] /= tlwh_output[3];
 	return tlwh_output;
 }
 
-vector<float> STrack::to_xyah()
+STRACK_BOX STrack::to_xyah() const
 {
 	return tlwh_to_xyah(tlwh);
 }
 
-vector<float> STrack::tlbr_to_tlwh(vector<float> &tlbr)
+STRACK_BOX STrack::tlbr_to_tlwh(const STRACK_BOX &tlbr)
 {
-	tlbr[2] -= tlbr[0];
-	tlbr[3] -= tlbr[1];
-	return tlbr;
+	STRACK_BOX tlwh_output = tlbr;
+	tlwh_output[2] -= tlwh_output[0];
+	tlwh_output[3] -= tlwh_output[1];
+	return tlwh_output;
 }
 
 void STrack::mark_lost()
@@ -180,28 +135,31 @@ void STrack::mark_removed()
 	state = TrackState::Removed;
 }
 
-int STrack::next_id()
+int STrack::end_frame() const
 {
-	static thread_local int _count = 0;
-	_count++;
-	return _count;
+	return this->frame_id;
 }
 
-int STrack::end_frame()
+const std::string &STrack::label_name() const
 {
-	return this->frame_id;
+	return id_to_label(this->label_id);
 }
 
-void STrack::multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &kalman_filter)
+int STrack::label_to_id(const std::string &label_name)
 {
-	for (int i = 0; i < stracks.size(); i++)
-	{
-		if (stracks[i]->state != TrackState::Tracked)
-		{
-			stracks[i]->mean[7] = 0;
-		}
-		kalman_filter.predict(stracks[i]->mean, stracks[i]->covariance);
-		stracks[i]->static_tlwh();
-		stracks[i]->static_tlbr();
-	}
-}
\ No newline at end of file
+	std::lock_guard<std::mutex> lock(label_mutex);
+	auto iter = label_ids.find(label_name);
+	if (iter != label_ids.end())
+		return iter->second;
+
+	label_names.push_back(label_name);
+	int label_id = label_names.size() - 1;
+	label_ids.emplace(label_name, label_id);
+	return label_id;
+}
+
+const std::string &STrack::id_to_label(int label_id)
+{
+	std::lock_guard<std::mutex> lock(label_mutex);
+	return label_names[label_id];
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <array>
+#include <string>
+#include <type_traits>
 #include "kalmanFilter.h"
 
 using namespace cv;
@@ -8,47 +11,54 @@ using namespace std;
 
 enum TrackState { New = 0, Tracked, Lost, Removed };
 
+typedef std::array<float, 4> STRACK_BOX;
+
+// Tracks are copied between pools every frame, so everything is stored inline: fixed-size boxes,
+// an interned label id and the slot of the Kalman state in the tracker's batched KalmanFilter.
 class STrack
 {
 public:
-	STrack(vector<float> tlwh_, float score, int class_id, int target_id, std::string label_name, std::array<int, 4> color);
-	~STrack();
+	STrack(const STRACK_BOX &tlwh_, float score, int class_id, int target_id, int label_id);
+
+	static STRACK_BOX tlbr_to_tlwh(const STRACK_BOX &tlbr);
+	static STRACK_BOX tlwh_to_xyah(const STRACK_BOX &tlwh_tmp);
 
-	vector<float> static tlbr_to_tlwh(vector<float> &tlbr);
-	void static multi_predict(vector<STrack*> &stracks, byte_kalman::KalmanFilter &kalman_filter);
-	void static_tlwh();
+	// label names are interned once and shared by all trackers
+	static int label_to_id(const std::string &label_name);
+	static const std::string &id_to_label(int label_id);
+
+	void static_tlwh(const byte_kalman::KalmanFilter &kalman_filter);
 	void static_tlbr();
-	vector<float> tlwh_to_xyah(vector<float> tlwh_tmp);
-	vector<float> to_xyah();
+	STRACK_BOX to_xyah() const;
 	void mark_lost();
 	void mark_removed();
-	int next_id();
-	int end_frame();
-	
-	void activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id);
-	void re_activate(STrack &new_track, int frame_id, bool new_id = false);
-	void update(STrack &new_track, int frame_id);
+	int end_frame() const;
+	const std::string &label_name() const;
+
+	// Track ids come from the owning BYTETracker, so they are unique per tracker whatever thread runs it
+	void activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id, int track_id);
+	// Only the track bookkeeping, the tracker runs the Kalman update for all matched tracks at once.
+	// A non-zero new_id replaces the track id.
+	void re_activate(const STrack &new_track, int frame_id, int new_id = 0);
+	void update(const STrack &new_track, int frame_id);
 
 public:
 	bool is_activated;
 	int track_id;
 	int target_id;
 	int class_id;
-	std::string label_name;
-	std::array<int, 4> color;
+	int label_id;
 	int state;
 
-	vector<float> _tlwh;
-	vector<float> tlwh;
-	vector<float> tlbr;
+	STRACK_BOX _tlwh;
+	STRACK_BOX tlwh;
+	STRACK_BOX tlbr;
 	int frame_id;
 	int tracklet_len;
 	int start_frame;
 
-	KAL_MEAN mean;
-	KAL_COVA covariance;
 	float score;
+	int kalman_slot;
+};
 
-private:
-	byte_kalman::KalmanFilter kalman_filter;
-};
\ No newline at end of file
+static_assert(std::is_trivially_copyable<STrack>::value, "STrack is copied between pools every frame");
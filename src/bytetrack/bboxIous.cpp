@@ -0,0 +1,126 @@
+#include "bboxIous.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+void BOX_SOA::clear()
+{
+	x1.clear();
+	y1.clear();
+	x2.clear();
+	y2.clear();
+	area.clear();
+}
+
+void BOX_SOA::push_back(const std::array<float, 4> &tlbr)
+{
+	x1.push_back(tlbr[0]);
+	y1.push_back(tlbr[1]);
+	x2.push_back(tlbr[2]);
+	y2.push_back(tlbr[3]);
+	area.push_back((tlbr[2] - tlbr[0] + 1) * (tlbr[3] - tlbr[1] + 1));
+}
+
+// Same arithmetic in every path: iw/ih clamped at 0, and the IoU is 0 whenever the intersection is empty
+void bbox_ious(const BOX_SOA &a, const BOX_SOA &b, float *ious)
+{
+	const int n = a.size();
+	const int m = b.size();
+	const float *bx1 = b.x1.data();
+	const float *by1 = b.y1.data();
+	const float *bx2 = b.x2.data();
+	const float *by2 = b.y2.data();
+	const float *barea = b.area.data();
+
+	for (int i = 0; i < n; i++)
+	{
+		float *row = ious + (size_t)i * m;
+		int j = 0;
+
+#if defined(__AVX__)
+		{
+			const __m256 ax1 = _mm256_set1_ps(a.x1[i]);
+			const __m256 ay1 = _mm256_set1_ps(a.y1[i]);
+			const __m256 ax2 = _mm256_set1_ps(a.x2[i]);
+			const __m256 ay2 = _mm256_set1_ps(a.y2[i]);
+			const __m256 aarea = _mm256_set1_ps(a.area[i]);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 zero = _mm256_setzero_ps();
+			for (; j + 8 <= m; j += 8)
+			{
+				__m256 iw = _mm256_sub_ps(_mm256_min_ps(ax2, _mm256_loadu_ps(bx2 + j)), _mm256_max_ps(ax1, _mm256_loadu_ps(bx1 + j)));
+				__m256 ih = _mm256_sub_ps(_mm256_min_ps(ay2, _mm256_loadu_ps(by2 + j)), _mm256_max_ps(ay1, _mm256_loadu_ps(by1 + j)));
+				iw = _mm256_max_ps(_mm256_add_ps(iw, one), zero);
+				ih = _mm256_max_ps(_mm256_add_ps(ih, one), zero);
+				const __m256 inter = _mm256_mul_ps(iw, ih);
+				const __m256 ua = _mm256_sub_ps(_mm256_add_ps(aarea, _mm256_loadu_ps(barea + j)), inter);
+				const __m256 mask = _mm256_cmp_ps(inter, zero, _CMP_GT_OQ);
+				_mm256_storeu_ps(row + j, _mm256_and_ps(mask, _mm256_div_ps(inter, ua)));
+			}
+		}
+#endif
+
+#if defined(__SSE2__)
+		{
+			const __m128 ax1 = _mm_set1_ps(a.x1[i]);
+			const __m128 ay1 = _mm_set1_ps(a.y1[i]);
+			const __m128 ax2 = _mm_set1_ps(a.x2[i]);
+			const __m128 ay2 = _mm_set1_ps(a.y2[i]);
+			const __m128 aarea = _mm_set1_ps(a.area[i]);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 zero = _mm_setzero_ps();
+			for (; j + 4 <= m; j += 4)
+			{
+				__m128 iw = _mm_sub_ps(_mm_min_ps(ax2, _mm_loadu_ps(bx2 + j)), _mm_max_ps(ax1, _mm_loadu_ps(bx1 + j)));
+				__m128 ih = _mm_sub_ps(_mm_min_ps(ay2, _mm_loadu_ps(by2 + j)), _mm_max_ps(ay1, _mm_loadu_ps(by1 + j)));
+				iw = _mm_max_ps(_mm_add_ps(iw, one), zero);
+				ih = _mm_max_ps(_mm_add_ps(ih, one), zero);
+				const __m128 inter = _mm_mul_ps(iw, ih);
+				const __m128 ua = _mm_sub_ps(_mm_add_ps(aarea, _mm_loadu_ps(barea + j)), inter);
+				const __m128 mask = _mm_cmpgt_ps(inter, zero);
+				_mm_storeu_ps(row + j, _mm_and_ps(mask, _mm_div_ps(inter, ua)));
+			}
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		{
+			const float32x4_t ax1 = vdupq_n_f32(a.x1[i]);
+			const float32x4_t ay1 = vdupq_n_f32(a.y1[i]);
+			const float32x4_t ax2 = vdupq_n_f32(a.x2[i]);
+			const float32x4_t ay2 = vdupq_n_f32(a.y2[i]);
+			const float32x4_t aarea = vdupq_n_f32(a.area[i]);
+			const float32x4_t one = vdupq_n_f32(1.0f);
+			const float32x4_t zero = vdupq_n_f32(0.0f);
+			for (; j + 4 <= m; j += 4)
+			{
+				float32x4_t iw = vsubq_f32(vminq_f32(ax2, vld1q_f32(bx2 + j)), vmaxq_f32(ax1, vld1q_f32(bx1 + j)));
+				float32x4_t ih = vsubq_f32(vminq_f32(ay2, vld1q_f32(by2 + j)), vmaxq_f32(ay1, vld1q_f32(by1 + j)));
+				iw = vmaxq_f32(vaddq_f32(iw, one), zero);
+				ih = vmaxq_f32(vaddq_f32(ih, one), zero);
+				const float32x4_t inter = vmulq_f32(iw, ih);
+				const float32x4_t ua = vsubq_f32(vaddq_f32(aarea, vld1q_f32(barea + j)), inter);
+				const uint32x4_t mask = vcgtq_f32(inter, zero);
+				const float32x4_t iou = vdivq_f32(inter, ua);
+				vst1q_f32(row + j, vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(iou))));
+			}
+		}
+#endif
+
+		for (; j < m; j++)
+		{
+			float iw = (a.x2[i] < bx2[j] ? a.x2[i] : bx2[j]) - (a.x1[i] > bx1[j] ? a.x1[i] : bx1[j]) + 1;
+			float ih = (a.y2[i] < by2[j] ? a.y2[i] : by2[j]) - (a.y1[i] > by1[j] ? a.y1[i] : by1[j]) + 1;
+			if (iw > 0 && ih > 0)
+			{
+				const float inter = iw * ih;
+				row[j] = inter / (a.area[i] + barea[j] - inter);
+			}
+			else
+			{
+				row[j] = 0.0;
+			}
+		}
+	}
+}
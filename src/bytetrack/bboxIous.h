@@ -0,0 +1,22 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Boxes in structure-of-arrays form (tlbr, area with the +1 pixel convention) for the vectorized IoU kernel
+struct BOX_SOA
+{
+	std::vector<float> x1;
+	std::vector<float> y1;
+	std::vector<float> x2;
+	std::vector<float> y2;
+	std::vector<float> area;
+
+	int size() const { return (int)x1.size(); }
+	void clear();
+	void push_back(const std::array<float, 4> &tlbr);
+};
+
+// ious[i * b.size() + j] = IoU(a[i], b[j]), vectorized over b with AVX / SSE2 / NEON, scalar otherwise
+void bbox_ious(const BOX_SOA &a, const BOX_SOA &b, float *ious);
@@ -20,6 +20,9 @@ typedef Eigen::Matrix<float, 4, 4, Eigen::RowMajor> KAL_HCOVA;
 using KAL_DATA = std::pair<KAL_MEAN, KAL_COVA>;
 using KAL_HDATA = std::pair<KAL_HMEAN, KAL_HCOVA>;
 
+using KAL_MEAN_MAP = Eigen::Map<KAL_MEAN, Eigen::Aligned32>;
+using KAL_COVA_MAP = Eigen::Map<KAL_COVA, Eigen::Aligned32>;
+
 //main
 using RESULT_DATA = std::pair<int, DETECTBOX>;
 
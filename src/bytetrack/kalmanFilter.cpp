@@ -30,7 +30,7 @@ namespace byte_kalman
 		this->_std_weight_velocity = 1. / 160;
 	}
 
-	KAL_DATA KalmanFilter::initiate(const DETECTBOX &measurement)
+	KAL_DATA KalmanFilter::initiate(const DETECTBOX &measurement) const
 	{
 		DETECTBOX mean_pos = measurement;
 		DETECTBOX mean_vel;
@@ -57,7 +57,7 @@ namespace byte_kalman
 		return std::make_pair(mean, var);
 	}
 
-	void KalmanFilter::predict(KAL_MEAN &mean, KAL_COVA &covariance)
+	void KalmanFilter::predict(KAL_MEAN_MAP mean, KAL_COVA_MAP covariance) const
 	{
 		//revise the data;
 		DETECTBOX std_pos;
@@ -83,7 +83,7 @@ namespace byte_kalman
 		covariance = covariance1;
 	}
 
-	KAL_HDATA KalmanFilter::project(const KAL_MEAN &mean, const KAL_COVA &covariance)
+	KAL_HDATA KalmanFilter::project(const KAL_MEAN &mean, const KAL_COVA &covariance) const
 	{
 		DETECTBOX std;
 		std << _std_weight_position * mean(3), _std_weight_position * mean(3),
@@ -101,7 +101,7 @@ namespace byte_kalman
 		KalmanFilter::update(
 			const KAL_MEAN &mean,
 			const KAL_COVA &covariance,
-			const DETECTBOX &measurement)
+			const DETECTBOX &measurement) const
 	{
 		KAL_HDATA pa = project(mean, covariance);
 		KAL_HMEAN projected_mean = pa.first;
@@ -149,4 +149,118 @@ namespace byte_kalman
 		auto square_maha = zz.colwise().sum();
 		return square_maha;
 	}
+
+	int KalmanFilter::alloc_slot()
+	{
+		if (!_free_slots.empty()) {
+			int slot = _free_slots.back();
+			_free_slots.pop_back();
+			return slot;
+		}
+
+		for (int i = 0; i < 8; i++) _mean[i].push_back(0);
+		for (int i = 0; i < 4; i++) {
+			_cov_pp[i].push_back(0);
+			_cov_pv[i].push_back(0);
+			_cov_vv[i].push_back(0);
+		}
+		return (int)_mean[0].size() - 1;
+	}
+
+	void KalmanFilter::release_slot(int slot)
+	{
+		_free_slots.push_back(slot);
+	}
+
+	void KalmanFilter::initiate(int slot, const DETECTBOX &measurement)
+	{
+		float std_pos[4] = {2 * _std_weight_position * measurement[3], 2 * _std_weight_position * measurement[3],
+			1e-2, 2 * _std_weight_position * measurement[3]};
+		float std_vel[4] = {10 * _std_weight_velocity * measurement[3], 10 * _std_weight_velocity * measurement[3],
+			1e-5, 10 * _std_weight_velocity * measurement[3]};
+
+		for (int i = 0; i < 4; i++) {
+			_mean[i][slot] = measurement[i];
+			_mean[i + 4][slot] = 0;
+			_cov_pp[i][slot] = std_pos[i] * std_pos[i];
+			_cov_pv[i][slot] = 0;
+			_cov_vv[i][slot] = std_vel[i] * std_vel[i];
+		}
+	}
+
+	// x' = x + v, P' = F P F^T + Q per coordinate block:
+	// pp' = (pp + pv) + (pv + vv) + q_pos, pv' = pv + vv, vv' = vv + q_vel
+	void KalmanFilter::predict(const std::vector<int> &slots)
+	{
+		float *h = _mean[3].data();
+		for (int i = 0; i < 4; i++) {
+			float *mp = _mean[i].data();
+			float *mv = _mean[i + 4].data();
+			float *pp = _cov_pp[i].data();
+			float *pv = _cov_pv[i].data();
+			float *vv = _cov_vv[i].data();
+			// the aspect ratio uses constant noise, the others scale with h
+			const float w_pos = i == 2 ? 0 : _std_weight_position;
+			const float w_vel = i == 2 ? 0 : _std_weight_velocity;
+			const float c_pos = i == 2 ? 1e-2 : 0;
+			const float c_vel = i == 2 ? 1e-5 : 0;
+
+			// h is read before its own row (i = 3) is predicted
+			for (int k = 0; k < slots.size(); k++) {
+				const int s = slots[k];
+				const float std_pos = w_pos * h[s] + c_pos;
+				const float std_vel = w_vel * h[s] + c_vel;
+				const float pv_vv = pv[s] + vv[s];
+				pp[s] = (pp[s] + pv[s]) + pv_vv + std_pos * std_pos;
+				pv[s] = pv_vv;
+				vv[s] = vv[s] + std_vel * std_vel;
+				mp[s] = mp[s] + mv[s];
+			}
+		}
+	}
+
+	// H = [I 0]: the projected covariance S is diagonal, so the Cholesky solve reduces to a
+	// division per coordinate and the gain has one position and one velocity entry
+	void KalmanFilter::update(const std::vector<int> &slots, const std::vector<DETECTBOX> &measurements)
+	{
+		const float *h = _mean[3].data();
+		for (int k = 0; k < slots.size(); k++) {
+			const int s = slots[k];
+			const float std_h = _std_weight_position * h[s];
+			const float std_r[4] = {std_h, std_h, 1e-1, std_h};
+
+			for (int i = 0; i < 4; i++) {
+				const float S = _cov_pp[i][s] + std_r[i] * std_r[i];
+				const float L = std::sqrt(S);
+				const float kp = _cov_pp[i][s] / L / L;
+				const float kv = _cov_pv[i][s] / L / L;
+				const float innovation = measurements[k][i] - _mean[i][s];
+
+				_mean[i][s] += innovation * kp;
+				_mean[i + 4][s] += innovation * kv;
+				_cov_pp[i][s] -= kp * S * kp;
+				_cov_pv[i][s] -= kp * S * kv;
+				_cov_vv[i][s] -= kv * S * kv;
+			}
+		}
+	}
+
+	KAL_MEAN KalmanFilter::mean(int slot) const
+	{
+		KAL_MEAN mean;
+		for (int i = 0; i < 8; i++) mean(i) = _mean[i][slot];
+		return mean;
+	}
+
+	KAL_COVA KalmanFilter::covariance(int slot) const
+	{
+		KAL_COVA covariance = KAL_COVA::Zero();
+		for (int i = 0; i < 4; i++) {
+			covariance(i, i) = _cov_pp[i][slot];
+			covariance(i, i + 4) = _cov_pv[i][slot];
+			covariance(i + 4, i) = _cov_pv[i][slot];
+			covariance(i + 4, i + 4) = _cov_vv[i][slot];
+		}
+		return covariance;
+	}
 }
\ No newline at end of file
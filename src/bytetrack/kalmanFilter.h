@@ -9,12 +9,12 @@ namespace byte_kalman
 	public:
 		static const double chi2inv95[10];
 		KalmanFilter();
-		KAL_DATA initiate(const DETECTBOX& measurement);
-		void predict(KAL_MEAN& mean, KAL_COVA& covariance);
-		KAL_HDATA project(const KAL_MEAN& mean, const KAL_COVA& covariance);
+		KAL_DATA initiate(const DETECTBOX& measurement) const;
+		void predict(KAL_MEAN_MAP mean, KAL_COVA_MAP covariance) const;
+		KAL_HDATA project(const KAL_MEAN& mean, const KAL_COVA& covariance) const;
 		KAL_DATA update(const KAL_MEAN& mean,
 			const KAL_COVA& covariance,
-			const DETECTBOX& measurement);
+			const DETECTBOX& measurement) const;
 
 		Eigen::Matrix<float, 1, -1> gating_distance(
 			const KAL_MEAN& mean,
@@ -22,10 +22,30 @@ namespace byte_kalman
 			const std::vector<DETECTBOX>& measurements,
 			bool only_position = false);
 
+		// Batched filter over track slots. With the constant-velocity motion matrix and diagonal
+		// noise the covariance never couples different coordinates, so each of x, y, a, h keeps
+		// only its 2x2 [pos, vel] block (pp, pv, vv) and all state lives in SoA arrays.
+		int alloc_slot();
+		void release_slot(int slot);
+		void initiate(int slot, const DETECTBOX& measurement);
+		void predict(const std::vector<int>& slots);
+		void update(const std::vector<int>& slots, const std::vector<DETECTBOX>& measurements);
+
+		float& mean(int slot, int i) { return _mean[i][slot]; }
+		float mean(int slot, int i) const { return _mean[i][slot]; }
+		KAL_MEAN mean(int slot) const;
+		KAL_COVA covariance(int slot) const;
+
 	private:
 		Eigen::Matrix<float, 8, 8, Eigen::RowMajor> _motion_mat;
 		Eigen::Matrix<float, 4, 8, Eigen::RowMajor> _update_mat;
 		float _std_weight_position;
 		float _std_weight_velocity;
+
+		std::vector<float> _mean[8];
+		std::vector<float> _cov_pp[4];
+		std::vector<float> _cov_pv[4];
+		std::vector<float> _cov_vv[4];
+		std::vector<int> _free_slots;
 	};
 }
\ No newline at end of file
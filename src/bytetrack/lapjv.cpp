@@ -4,13 +4,24 @@
 
 #include "lapjv.h"
 
+/** Row access for a contiguous row-major n x n cost matrix, so the dense
+ * routines below can index it as cost[i][j] like the cost_t *cost[] form.
+ */
+template <typename T>
+struct dense_rows
+{
+	const T *data;
+	uint_t n;
+	const T *operator[](const uint_t i) const { return data + (size_t)i * n; }
+};
+
 /** Column-reduction and reduction transfer for a dense cost matrix.
  */
-int_t _ccrrt_dense(const uint_t n, cost_t *cost[],
-	int_t *free_rows, int_t *x, int_t *y, cost_t *v)
+template <typename T, typename C>
+int_t _ccrrt_dense(const uint_t n, C cost,
+	int_t *free_rows, int_t *x, int_t *y, T *v, boolean *unique)
 {
 	int_t n_free_rows;
-	boolean *unique;
 
 	for (uint_t i = 0; i < n; i++) {
 		x[i] = -1;
@@ -19,7 +30,7 @@ int_t _ccrrt_dense(const uint_t n, cost_t *cost[],
 	}
 	for (uint_t i = 0; i < n; i++) {
 		for (uint_t j = 0; j < n; j++) {
-			const cost_t c = cost[i][j];
+			const T c = cost[i][j];
 			if (c < v[j]) {
 				v[j] = c;
 				y[j] = i;
@@ -29,7 +40,6 @@ int_t _ccrrt_dense(const uint_t n, cost_t *cost[],
 	}
 	PRINT_COST_ARRAY(v, n);
 	PRINT_INDEX_ARRAY(y, n);
-	NEW(unique, boolean, n);
 	memset(unique, TRUE, n);
 	{
 		int_t j = n;
@@ -52,12 +62,12 @@ int_t _ccrrt_dense(const uint_t n, cost_t *cost[],
 		}
 		else if (unique[i]) {
 			const int_t j = x[i];
-			cost_t min = LARGE;
+			T min = LARGE;
 			for (uint_t j2 = 0; j2 < n; j2++) {
 				if (j2 == (uint_t)j) {
 					continue;
 				}
-				const cost_t c = cost[i][j2] - v[j2];
+				const T c = cost[i][j2] - v[j2];
 				if (c < min) {
 					min = c;
 				}
@@ -66,17 +76,17 @@ int_t _ccrrt_dense(const uint_t n, cost_t *cost[],
 			v[j] -= min;
 		}
 	}
-	FREE(unique);
 	return n_free_rows;
 }
 
 
 /** Augmenting row reduction for a dense cost matrix.
  */
+template <typename T, typename C>
 int_t _carr_dense(
-	const uint_t n, cost_t *cost[],
+	const uint_t n, C cost,
 	const uint_t n_free_rows,
-	int_t *free_rows, int_t *x, int_t *y, cost_t *v)
+	int_t *free_rows, int_t *x, int_t *y, T *v)
 {
 	uint_t current = 0;
 	int_t new_free_rows = 0;
@@ -88,7 +98,7 @@ int_t _carr_dense(
 	while (current < n_free_rows) {
 		int_t i0;
 		int_t j1, j2;
-		cost_t v1, v2, v1_new;
+		T v1, v2, v1_new;
 		boolean v1_lowers;
 
 		rr_cnt++;
@@ -100,7 +110,7 @@ int_t _carr_dense(
 		v2 = LARGE;
 		for (uint_t j = 1; j < n; j++) {
 			PRINTF("%d = %f %d = %f\n", j1, v1, j2, v2);
-			const cost_t c = cost[free_i][j] - v[j];
+			const T c = cost[free_i][j] - v[j];
 			if (c < v2) {
 				if (c >= v1) {
 					v2 = c;
@@ -150,10 +160,11 @@ int_t _carr_dense(
 
 /** Find columns with minimum d[j] and put them on the SCAN list.
  */
-uint_t _find_dense(const uint_t n, uint_t lo, cost_t *d, int_t *cols, int_t *y)
+template <typename T>
+uint_t _find_dense(const uint_t n, uint_t lo, T *d, int_t *cols)
 {
 	uint_t hi = lo + 1;
-	cost_t mind = d[cols[lo]];
+	T mind = d[cols[lo]];
 	for (uint_t k = hi; k < n; k++) {
 		int_t j = cols[k];
 		if (d[j] <= mind) {
@@ -171,19 +182,20 @@ uint_t _find_dense(const uint_t n, uint_t lo, cost_t *d, int_t *cols, int_t *y)
 
 // Scan all columns in TODO starting from arbitrary column in SCAN
 // and try to decrease d of the TODO columns using the SCAN column.
-int_t _scan_dense(const uint_t n, cost_t *cost[],
+template <typename T, typename C>
+int_t _scan_dense(const uint_t n, C cost,
 	uint_t *plo, uint_t*phi,
-	cost_t *d, int_t *cols, int_t *pred,
-	int_t *y, cost_t *v)
+	T *d, int_t *cols, int_t *pred,
+	int_t *y, T *v)
 {
 	uint_t lo = *plo;
 	uint_t hi = *phi;
-	cost_t h, cred_ij;
+	T h, cred_ij;
 
 	while (lo != hi) {
 		int_t j = cols[lo++];
 		const int_t i = y[j];
-		const cost_t mind = d[j];
+		const T mind = d[j];
 		h = cost[i][j] - v[j] - mind;
 		PRINTF("i=%d j=%d h=%f\n", i, j, h);
 		// For all columns in TODO
@@ -215,20 +227,16 @@ int_t _scan_dense(const uint_t n, cost_t *cost[],
  *
  * \return The closest free column index.
  */
+template <typename T, typename C>
 int_t find_path_dense(
-	const uint_t n, cost_t *cost[],
+	const uint_t n, C cost,
 	const int_t start_i,
-	int_t *y, cost_t *v,
-	int_t *pred)
+	int_t *y, T *v,
+	int_t *pred, int_t *cols, T *d)
 {
 	uint_t lo = 0, hi = 0;
 	int_t final_j = -1;
 	uint_t n_ready = 0;
-	int_t *cols;
-	cost_t *d;
-
-	NEW(cols, int_t, n);
-	NEW(d, cost_t, n);
 
 	for (uint_t i = 0; i < n; i++) {
 		cols[i] = i;
@@ -241,7 +249,7 @@ int_t find_path_dense(
 		if (lo == hi) {
 			PRINTF("%d..%d -> find\n", lo, hi);
 			n_ready = lo;
-			hi = _find_dense(n, lo, d, cols, y);
+			hi = _find_dense(n, lo, d, cols);
 			PRINTF("check %d..%d\n", lo, hi);
 			PRINT_INDEX_ARRAY(cols, n);
 			for (uint_t k = lo; k < hi; k++) {
@@ -264,37 +272,32 @@ int_t find_path_dense(
 	PRINTF("found final_j=%d\n", final_j);
 	PRINT_INDEX_ARRAY(cols, n);
 	{
-		const cost_t mind = d[cols[lo]];
+		const T mind = d[cols[lo]];
 		for (uint_t k = 0; k < n_ready; k++) {
 			const int_t j = cols[k];
 			v[j] += d[j] - mind;
 		}
 	}
 
-	FREE(cols);
-	FREE(d);
-
 	return final_j;
 }
 
 
 /** Augment for a dense cost matrix.
  */
+template <typename T, typename C>
 int_t _ca_dense(
-	const uint_t n, cost_t *cost[],
+	const uint_t n, C cost,
 	const uint_t n_free_rows,
-	int_t *free_rows, int_t *x, int_t *y, cost_t *v)
+	int_t *free_rows, int_t *x, int_t *y, T *v,
+	int_t *pred, int_t *cols, T *d)
 {
-	int_t *pred;
-
-	NEW(pred, int_t, n);
-
 	for (int_t *pfree_i = free_rows; pfree_i < free_rows + n_free_rows; pfree_i++) {
 		int_t i = -1, j;
 		uint_t k = 0;
 
 		PRINTF("looking at free_i=%d\n", *pfree_i);
-		j = find_path_dense(n, cost, *pfree_i, y, v, pred);
+		j = find_path_dense(n, cost, *pfree_i, y, v, pred, cols, d);
 		ASSERT(j >= 0);
 		ASSERT(j < n);
 		while (i != *pfree_i) {
@@ -311,11 +314,29 @@ int_t _ca_dense(
 			}
 		}
 	}
-	FREE(pred);
 	return 0;
 }
 
 
+/** Solve dense sparse LAP with caller-provided scratch arrays of n elements each.
+ */
+template <typename T, typename C>
+int_t _lapjv_dense(const uint_t n, C cost, int_t *x, int_t *y,
+	int_t *free_rows, T *v, boolean *unique, int_t *pred, int_t *cols, T *d)
+{
+	int_t ret = _ccrrt_dense(n, cost, free_rows, x, y, v, unique);
+	int i = 0;
+	while (ret > 0 && i < 2) {
+		ret = _carr_dense(n, cost, ret, free_rows, x, y, v);
+		i++;
+	}
+	if (ret > 0) {
+		ret = _ca_dense(n, cost, ret, free_rows, x, y, v, pred, cols, d);
+	}
+	return ret;
+}
+
+
 /** Solve dense sparse LAP.
  */
 int lapjv_internal(
@@ -323,21 +344,43 @@ int lapjv_internal(
 	int_t *x, int_t *y)
 {
 	int ret;
-	int_t *free_rows;
-	cost_t *v;
+	int_t *free_rows, *pred, *cols;
+	cost_t *v, *d;
+	boolean *unique;
 
 	NEW(free_rows, int_t, n);
 	NEW(v, cost_t, n);
-	ret = _ccrrt_dense(n, cost, free_rows, x, y, v);
-	int i = 0;
-	while (ret > 0 && i < 2) {
-		ret = _carr_dense(n, cost, ret, free_rows, x, y, v);
-		i++;
-	}
-	if (ret > 0) {
-		ret = _ca_dense(n, cost, ret, free_rows, x, y, v);
-	}
+	NEW(unique, boolean, n);
+	NEW(pred, int_t, n);
+	NEW(cols, int_t, n);
+	NEW(d, cost_t, n);
+	ret = _lapjv_dense(n, cost, x, y, free_rows, v, unique, pred, cols, d);
+	FREE(d);
+	FREE(cols);
+	FREE(pred);
+	FREE(unique);
 	FREE(v);
 	FREE(free_rows);
 	return ret;
-}
\ No newline at end of file
+}
+
+
+/** Solve dense sparse LAP on a contiguous row-major float matrix, reusing the workspace.
+ */
+int lapjv_internal_f(
+	const uint_t n, const float *cost,
+	int_t *x, int_t *y, lapjv_workspace &workspace)
+{
+	if (workspace.free_rows.size() < n) {
+		workspace.free_rows.resize(n);
+		workspace.pred.resize(n);
+		workspace.cols.resize(n);
+		workspace.unique.resize(n);
+		workspace.v.resize(n);
+		workspace.d.resize(n);
+	}
+
+	dense_rows<float> rows = {cost, n};
+	return _lapjv_dense(n, rows, x, y, workspace.free_rows.data(), workspace.v.data(), workspace.unique.data(),
+		workspace.pred.data(), workspace.cols.data(), workspace.d.data());
+}
@@ -60,4 +60,23 @@ extern int_t lapjv_internal(
 	const uint_t n, cost_t *cost[],
 	int_t *x, int_t *y);
 
+#include <vector>
+
+/** Scratch arrays for lapjv_internal_f, grown on demand and kept across calls.
+ */
+struct lapjv_workspace {
+	std::vector<int_t> free_rows;
+	std::vector<int_t> pred;
+	std::vector<int_t> cols;
+	std::vector<boolean> unique;
+	std::vector<float> v;
+	std::vector<float> d;
+};
+
+/** Float version on a contiguous row-major n x n cost matrix, no allocation once the workspace is large enough.
+ */
+extern int_t lapjv_internal_f(
+	const uint_t n, const float *cost,
+	int_t *x, int_t *y, lapjv_workspace &workspace);
+
 #endif // LAPJV_H
\ No newline at end of file
@@ -1,123 +1,143 @@
 #include "BYTETracker.h"
 #include "lapjv.h"
 
-vector<STrack*> BYTETracker::joint_stracks(vector<STrack*> &tlista, vector<STrack> &tlistb)
+int BYTETracker::next_id()
 {
-	map<int, int> exists;
-	vector<STrack*> res;
-	for (int i = 0; i < tlista.size(); i++)
-	{
-		exists.insert(pair<int, int>(tlista[i]->track_id, 1));
-		res.push_back(tlista[i]);
-	}
-	for (int i = 0; i < tlistb.size(); i++)
-	{
-		int tid = tlistb[i].track_id;
-		if (!exists[tid] || exists.count(tid) == 0)
-		{
-			exists[tid] = 1;
-			res.push_back(&tlistb[i]);
-		}
-	}
-	return res;
+	return ++this->track_id_count;
 }
 
-vector<STrack> BYTETracker::joint_stracks(vector<STrack> &tlista, vector<STrack> &tlistb)
+void BYTETracker::remove_duplicate_stracks()
 {
-	map<int, int> exists;
-	vector<STrack> res;
-	for (int i = 0; i < tlista.size(); i++)
+	tracked_stracks.clear();
+	lost_stracks.clear();
+	for (int i = 0; i < this->stracks.size(); i++)
 	{
-		exists.insert(pair<int, int>(tlista[i].track_id, 1));
-		res.push_back(tlista[i]);
+		if (this->stracks[i].state == TrackState::Tracked)
+			tracked_stracks.push_back(i);
+		else if (this->stracks[i].state == TrackState::Lost)
+			lost_stracks.push_back(i);
 	}
-	for (int i = 0; i < tlistb.size(); i++)
+
+	int dist_size = 0, dist_size_size = 0;
+	gather_tlbrs(this->stracks, tracked_stracks, atlbrs);
+	gather_tlbrs(this->stracks, lost_stracks, btlbrs);
+	iou_distance(atlbrs, btlbrs, dists, dist_size, dist_size_size);
+
+	// A tracked and a lost track on the same target: keep the one tracked for longer
+	for (int i = 0; i < dist_size; i++)
 	{
-		int tid = tlistb[i].track_id;
-		if (!exists[tid] || exists.count(tid) == 0)
+		for (int j = 0; j < dist_size_size; j++)
 		{
-			exists[tid] = 1;
-			res.push_back(tlistb[i]);
+			if (dists[i * dist_size_size + j] >= 0.15)
+				continue;
+
+			STrack &tracka = this->stracks[tracked_stracks[i]];
+			STrack &trackb = this->stracks[lost_stracks[j]];
+			int timep = tracka.frame_id - tracka.start_frame;
+			int timeq = trackb.frame_id - trackb.start_frame;
+			if (timep > timeq)
+				trackb.mark_removed();
+			else
+				tracka.mark_removed();
 		}
 	}
-	return res;
 }
 
-vector<STrack> BYTETracker::sub_stracks(vector<STrack> &tlista, vector<STrack> &tlistb)
+void BYTETracker::remove_oldest_lost_strack()
 {
-	map<int, STrack> stracks;
-	for (int i = 0; i < tlista.size(); i++)
+	// Cap the lost pool by dropping the track lost for the longest time
+	int lost_count = 0;
+	int oldest = -1;
+	for (int i = 0; i < this->stracks.size(); i++)
 	{
-		stracks.insert(pair<int, STrack>(tlista[i].track_id, tlista[i]));
+		const STrack &track = this->stracks[i];
+		if (track.state != TrackState::Lost)
+			continue;
+		lost_count++;
+		if (oldest < 0 || track.frame_id < this->stracks[oldest].frame_id
+			|| (track.frame_id == this->stracks[oldest].frame_id && track.track_id < this->stracks[oldest].track_id))
+			oldest = i;
 	}
-	for (int i = 0; i < tlistb.size(); i++)
+
+	if (lost_count > 200)
+		this->stracks[oldest].mark_removed();
+}
+
+void BYTETracker::multi_predict(const vector<int> &indices)
+{
+	kalman_slots.clear();
+	for (int i = 0; i < indices.size(); i++)
 	{
-		int tid = tlistb[i].track_id;
-		if (stracks.count(tid) != 0)
+		STrack &track = this->stracks[indices[i]];
+		if (track.state != TrackState::Tracked)
 		{
-			stracks.erase(tid);
+			this->kalman_filter.mean(track.kalman_slot, 7) = 0;
 		}
+		kalman_slots.push_back(track.kalman_slot);
 	}
 
-	vector<STrack> res;
-	std::map<int, STrack>::iterator  it;
-	for (it = stracks.begin(); it != stracks.end(); ++it)
+	this->kalman_filter.predict(kalman_slots);
+	for (int i = 0; i < indices.size(); i++)
 	{
-		res.push_back(it->second);
+		STrack &track = this->stracks[indices[i]];
+		track.static_tlwh(this->kalman_filter);
+		track.static_tlbr();
 	}
-
-	return res;
 }
 
-void BYTETracker::remove_duplicate_stracks(vector<STrack> &resa, vector<STrack> &resb, vector<STrack> &stracksa, vector<STrack> &stracksb)
+void BYTETracker::update_matches(const vector<int> &track_indices, const vector<STrack> &dets)
 {
-	vector<vector<float> > pdist = iou_distance(stracksa, stracksb);
-	vector<pair<int, int> > pairs;
-	for (int i = 0; i < pdist.size(); i++)
+	kalman_slots.clear();
+	kalman_measurements.clear();
+	for (int i = 0; i < matches.size(); i++)
 	{
-		for (int j = 0; j < pdist[i].size(); j++)
-		{
-			if (pdist[i][j] < 0.15)
-			{
-				pairs.push_back(pair<int, int>(i, j));
-			}
-		}
+		STrack &track = this->stracks[track_indices[matches[i].first]];
+		const STrack &det = dets[matches[i].second];
+		if (track.state == TrackState::Tracked)
+			track.update(det, this->frame_id);
+		else
+			track.re_activate(det, this->frame_id);
+
+		STRACK_BOX xyah = det.to_xyah();
+		kalman_slots.push_back(track.kalman_slot);
+		kalman_measurements.push_back(DETECTBOX(xyah[0], xyah[1], xyah[2], xyah[3]));
 	}
 
-	vector<int> dupa, dupb;
-	for (int i = 0; i < pairs.size(); i++)
+	this->kalman_filter.update(kalman_slots, kalman_measurements);
+	for (int i = 0; i < matches.size(); i++)
 	{
-		int timep = stracksa[pairs[i].first].frame_id - stracksa[pairs[i].first].start_frame;
-		int timeq = stracksb[pairs[i].second].frame_id - stracksb[pairs[i].second].start_frame;
-		if (timep > timeq)
-			dupb.push_back(pairs[i].second);
-		else
-			dupa.push_back(pairs[i].first);
+		STrack &track = this->stracks[track_indices[matches[i].first]];
+		track.static_tlwh(this->kalman_filter);
+		track.static_tlbr();
 	}
+}
 
-	for (int i = 0; i < stracksa.size(); i++)
+void BYTETracker::gather_tlbrs(const vector<STrack> &tracks, const vector<int> &indices, BOX_SOA &tlbrs)
+{
+	tlbrs.clear();
+	for (int i = 0; i < indices.size(); i++)
 	{
-		vector<int>::iterator iter = find(dupa.begin(), dupa.end(), i);
-		if (iter == dupa.end())
-		{
-			resa.push_back(stracksa[i]);
-		}
+		tlbrs.push_back(tracks[indices[i]].tlbr);
 	}
+}
 
-	for (int i = 0; i < stracksb.size(); i++)
+void BYTETracker::gather_tlbrs(const vector<STrack> &tracks, BOX_SOA &tlbrs)
+{
+	tlbrs.clear();
+	for (int i = 0; i < tracks.size(); i++)
 	{
-		vector<int>::iterator iter = find(dupb.begin(), dupb.end(), i);
-		if (iter == dupb.end())
-		{
-			resb.push_back(stracksb[i]);
-		}
+		tlbrs.push_back(tracks[i].tlbr);
 	}
 }
 
-void BYTETracker::linear_assignment(vector<vector<float> > &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
-	vector<vector<int> > &matches, vector<int> &unmatched_a, vector<int> &unmatched_b)
+void BYTETracker::linear_assignment(const vector<float> &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
+	vector<MATCH_DATA> &matches, vector<int> &unmatched_a, vector<int> &unmatched_b)
 {
-	if (cost_matrix.size() == 0)
+	matches.clear();
+	unmatched_a.clear();
+	unmatched_b.clear();
+
+	if (cost_matrix_size * cost_matrix_size_size == 0)
 	{
 		for (int i = 0; i < cost_matrix_size; i++)
 		{
@@ -130,16 +150,12 @@ void BYTETracker::linear_assignment(vector<vector<float> > &cost_matrix, int cos
 		return;
 	}
 
-	vector<int> rowsol; vector<int> colsol;
-	float c = lapjv(cost_matrix, rowsol, colsol, true, thresh);
+	lapjv(cost_matrix, cost_matrix_size, cost_matrix_size_size, rowsol, colsol, true, thresh, false);
 	for (int i = 0; i < rowsol.size(); i++)
 	{
 		if (rowsol[i] >= 0)
 		{
-			vector<int> match;
-			match.push_back(i);
-			match.push_back(rowsol[i]);
-			matches.push_back(match);
+			matches.push_back(MATCH_DATA(i, rowsol[i]));
 		}
 		else
 		{
@@ -156,123 +172,33 @@ void BYTETracker::linear_assignment(vector<vector<float> > &cost_matrix, int cos
 	}
 }
 
-vector<vector<float> > BYTETracker::ious(vector<vector<float> > &atlbrs, vector<vector<float> > &btlbrs)
+void BYTETracker::ious(const BOX_SOA &atlbrs, const BOX_SOA &btlbrs, vector<float> &ious)
 {
-	vector<vector<float> > ious;
-	if (atlbrs.size()*btlbrs.size() == 0)
-		return ious;
-
-	ious.resize(atlbrs.size());
-	for (int i = 0; i < ious.size(); i++)
-	{
-		ious[i].resize(btlbrs.size());
-	}
-
-	//bbox_ious
-	for (int k = 0; k < btlbrs.size(); k++)
-	{
-		vector<float> ious_tmp;
-		float box_area = (btlbrs[k][2] - btlbrs[k][0] + 1)*(btlbrs[k][3] - btlbrs[k][1] + 1);
-		for (int n = 0; n < atlbrs.size(); n++)
-		{
-			float iw = min(atlbrs[n][2], btlbrs[k][2]) - max(atlbrs[n][0], btlbrs[k][0]) + 1;
-			if (iw > 0)
-			{
-				float ih = min(atlbrs[n][3], btlbrs[k][3]) - max(atlbrs[n][1], btlbrs[k][1]) + 1;
-				if(ih > 0)
-				{
-					float ua = (atlbrs[n][2] - atlbrs[n][0] + 1)*(atlbrs[n][3] - atlbrs[n][1] + 1) + box_area - iw * ih;
-					ious[n][k] = iw * ih / ua;
-				}
-				else
-				{
-					ious[n][k] = 0.0;
-				}
-			}
-			else
-			{
-				ious[n][k] = 0.0;
-			}
-		}
-	}
-
-	return ious;
+	ious.resize((size_t)atlbrs.size() * btlbrs.size());
+	bbox_ious(atlbrs, btlbrs, ious.data());
 }
 
-vector<vector<float> > BYTETracker::iou_distance(vector<STrack*> &atracks, vector<STrack> &btracks, int &dist_size, int &dist_size_size)
+void BYTETracker::iou_distance(const BOX_SOA &atlbrs, const BOX_SOA &btlbrs, vector<float> &cost_matrix,
+	int &dist_size, int &dist_size_size)
 {
-	vector<vector<float> > cost_matrix;
-	if (atracks.size() * btracks.size() == 0)
+	dist_size = atlbrs.size();
+	dist_size_size = btlbrs.size();
+	if (atlbrs.size() * btlbrs.size() == 0)
 	{
-		dist_size = atracks.size();
-		dist_size_size = btracks.size();
-		return cost_matrix;
-	}
-	vector<vector<float> > atlbrs, btlbrs;
-	for (int i = 0; i < atracks.size(); i++)
-	{
-		atlbrs.push_back(atracks[i]->tlbr);
-	}
-	for (int i = 0; i < btracks.size(); i++)
-	{
-		btlbrs.push_back(btracks[i].tlbr);
-	}
-
-	dist_size = atracks.size();
-	dist_size_size = btracks.size();
-
-	vector<vector<float> > _ious = ious(atlbrs, btlbrs);
-	
-	for (int i = 0; i < _ious.size();i++)
-	{
-		vector<float> _iou;
-		for (int j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
-	}
-
-	return cost_matrix;
-}
-
-vector<vector<float> > BYTETracker::iou_distance(vector<STrack> &atracks, vector<STrack> &btracks)
-{
-	vector<vector<float> > atlbrs, btlbrs;
-	for (int i = 0; i < atracks.size(); i++)
-	{
-		atlbrs.push_back(atracks[i].tlbr);
-	}
-	for (int i = 0; i < btracks.size(); i++)
-	{
-		btlbrs.push_back(btracks[i].tlbr);
+		cost_matrix.clear();
+		return;
 	}
 
-	vector<vector<float> > _ious = ious(atlbrs, btlbrs);
-	vector<vector<float> > cost_matrix;
-	for (int i = 0; i < _ious.size(); i++)
+	ious(atlbrs, btlbrs, cost_matrix);
+	for (int i = 0; i < cost_matrix.size(); i++)
 	{
-		vector<float> _iou;
-		for (int j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
+		cost_matrix[i] = 1 - cost_matrix[i];
 	}
-
-	return cost_matrix;
 }
 
-double BYTETracker::lapjv(const vector<vector<float> > &cost, vector<int> &rowsol, vector<int> &colsol,
+double BYTETracker::lapjv(const vector<float> &cost, int n_rows, int n_cols, vector<int> &rowsol, vector<int> &colsol,
 	bool extend_cost, float cost_limit, bool return_cost)
 {
-	vector<vector<float> > cost_c;
-	cost_c.assign(cost.begin(), cost.end());
-
-	vector<vector<float> > cost_c_extended;
-
-	int n_rows = cost.size();
-	int n_cols = cost[0].size();
 	rowsol.resize(n_rows);
 	colsol.resize(n_cols);
 
@@ -288,80 +214,45 @@ double BYTETracker::lapjv(const vector<vector<float> > &cost, vector<int> &rowso
 			printf("set extend_cost=True\n");
 		}
 	}
-		
+
+	const float *cost_ptr = cost.data();
 	if (extend_cost || cost_limit < LONG_MAX)
 	{
 		n = n_rows + n_cols;
-		cost_c_extended.resize(n);
-		for (int i = 0; i < cost_c_extended.size(); i++)
-			cost_c_extended[i].resize(n);
 
+		float cost_fill;
 		if (cost_limit < LONG_MAX)
 		{
-			for (int i = 0; i < cost_c_extended.size(); i++)
-			{
-				for (int j = 0; j < cost_c_extended[i].size(); j++)
-				{
-					cost_c_extended[i][j] = cost_limit / 2.0;
-				}
-			}
+			cost_fill = cost_limit / 2.0;
 		}
 		else
 		{
 			float cost_max = -1;
-			for (int i = 0; i < cost_c.size(); i++)
-			{
-				for (int j = 0; j < cost_c[i].size(); j++)
-				{
-					if (cost_c[i][j] > cost_max)
-						cost_max = cost_c[i][j];
-				}
-			}
-			for (int i = 0; i < cost_c_extended.size(); i++)
+			for (int i = 0; i < n_rows * n_cols; i++)
 			{
-				for (int j = 0; j < cost_c_extended[i].size(); j++)
-				{
-					cost_c_extended[i][j] = cost_max + 1;
-				}
+				if (cost[i] > cost_max)
+					cost_max = cost[i];
 			}
+			cost_fill = cost_max + 1;
 		}
 
-		for (int i = n_rows; i < cost_c_extended.size(); i++)
-		{
-			for (int j = n_cols; j < cost_c_extended[i].size(); j++)
-			{
-				cost_c_extended[i][j] = 0;
-			}
-		}
+		// [cost, fill; fill, 0] in one n x n buffer
+		cost_extended.assign((size_t)n * n, cost_fill);
 		for (int i = 0; i < n_rows; i++)
 		{
-			for (int j = 0; j < n_cols; j++)
-			{
-				cost_c_extended[i][j] = cost_c[i][j];
-			}
+			std::copy(cost.begin() + i * n_cols, cost.begin() + (i + 1) * n_cols, cost_extended.begin() + i * n);
 		}
-
-		cost_c.clear();
-		cost_c.assign(cost_c_extended.begin(), cost_c_extended.end());
-	}
-
-	double **cost_ptr;
-	cost_ptr = new double *[sizeof(double *) * n];
-	for (int i = 0; i < n; i++)
-		cost_ptr[i] = new double[sizeof(double) * n];
-
-	for (int i = 0; i < n; i++)
-	{
-		for (int j = 0; j < n; j++)
+		for (int i = n_rows; i < n; i++)
 		{
-			cost_ptr[i][j] = cost_c[i][j];
+			std::fill(cost_extended.begin() + i * n + n_cols, cost_extended.begin() + (i + 1) * n, 0.0f);
 		}
+		cost_ptr = cost_extended.data();
 	}
 
-	int* x_c = new int[sizeof(int) * n];
-	int *y_c = new int[sizeof(int) * n];
+	x_c.resize(n);
+	y_c.resize(n);
 
-	int ret = lapjv_internal(n, cost_ptr, x_c, y_c);
+	int ret = lapjv_internal_f(n, cost_ptr, x_c.data(), y_c.data(), *lapjv_ws);
 	if (ret != 0)
 	{
 		printf("Calculate Wrong!\n");
@@ -393,27 +284,30 @@ double BYTETracker::lapjv(const vector<vector<float> > &cost, vector<int> &rowso
 			{
 				if (rowsol[i] != -1)
 				{
-					//cout << i << "\t" << rowsol[i] << "\t" << cost_ptr[i][rowsol[i]] << endl;
-					opt += cost_ptr[i][rowsol[i]];
+					opt += cost_ptr[i * n + rowsol[i]];
 				}
 			}
 		}
 	}
-	else if (return_cost)
+	else
 	{
-		for (int i = 0; i < rowsol.size(); i++)
+		for (int i = 0; i < n_rows; i++)
 		{
-			opt += cost_ptr[i][rowsol[i]];
+			rowsol[i] = x_c[i];
+		}
+		for (int i = 0; i < n_cols; i++)
+		{
+			colsol[i] = y_c[i];
 		}
-	}
 
-	for (int i = 0; i < n; i++)
-	{
-		delete[]cost_ptr[i];
+		if (return_cost)
+		{
+			for (int i = 0; i < rowsol.size(); i++)
+			{
+				opt += cost_ptr[i * n + rowsol[i]];
+			}
+		}
 	}
-	delete[]cost_ptr;
-	delete[]x_c;
-	delete[]y_c;
 
 	return opt;
 }
@@ -0,0 +1,1068 @@
+#include "cascade.h"
+#include "../bytetrack/BYTETracker.h"
+#include "../sequence_statistic.h"
+#include "../utils.h"
+#include "reorder_buffer.h"
+#include "trace_buffer.h"
+#include "spdlog/spdlog.h"
+#include <api/global_config.h>
+#include <bmcv_api_ext.h>
+#include <common/type_convert.h>
+#include <core/alg_param.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace gddi {
+
+CascadeStage CascadeStage::detect(const int model_index, const ObjectFilter &filter,
+                                  const DetectCacheConfig &cache, const bool motion_gate) {
+    CascadeStage stage{};
+    stage.type = Type::kDetect;
+    stage.model_index = model_index;
+    stage.filter = filter;
+    stage.cache = cache;
+    stage.motion_gate = motion_gate;
+    return stage;
+}
+
+CascadeStage CascadeStage::crop_detect(const int model_index, const CropMerge merge, const ObjectFilter &filter,
+                                       const int crop_limit_model, const CropCacheConfig &cache) {
+    CascadeStage stage{};
+    stage.type = Type::kCropDetect;
+    stage.model_index = model_index;
+    stage.filter = filter;
+    stage.crop_merge = merge;
+    stage.crop_limit_model = crop_limit_model;
+    stage.crop_cache = cache;
+    return stage;
+}
+
+CascadeStage CascadeStage::track() {
+    CascadeStage stage{};
+    stage.type = Type::kTrack;
+    return stage;
+}
+
+CascadeStage CascadeStage::top_k(const int model_index) {
+    CascadeStage stage{};
+    stage.type = Type::kTopK;
+    stage.model_index = model_index;
+    return stage;
+}
+
+CascadeStage CascadeStage::filter_if(std::function<bool(const AlgoObject &)> predicate) {
+    CascadeStage stage{};
+    stage.type = Type::kFilter;
+    stage.predicate = std::move(predicate);
+    return stage;
+}
+
+CascadeStage CascadeStage::zone() {
+    CascadeStage stage{};
+    stage.type = Type::kZone;
+    return stage;
+}
+
+CascadeStage CascadeStage::crop_cover_merge(const int model_index, const ObjectFilter &filter,
+                                            const std::set<std::string> &include_labels,
+                                            const std::set<std::string> &exclude_labels, const std::string &map_label,
+                                            const float cover_threshold, const CropCacheConfig &cache) {
+    auto stage = crop_detect(model_index, CropMerge::kCover, filter, -1, cache);
+    stage.include_labels = include_labels;
+    stage.exclude_labels = exclude_labels;
+    stage.map_label = map_label;
+    stage.cover_threshold = cover_threshold;
+    return stage;
+}
+
+CascadeStage CascadeStage::statistic() {
+    CascadeStage stage{};
+    stage.type = Type::kStatistic;
+    return stage;
+}
+
+CascadeStage CascadeStage::finish_if(std::function<bool(const std::vector<AlgoObject> &)> condition) {
+    CascadeStage stage{};
+    stage.type = Type::kFinishIf;
+    stage.condition = std::move(condition);
+    return stage;
+}
+
+CascadeStage CascadeStage::finish_if_empty() {
+    return finish_if([](const std::vector<AlgoObject> &objects) { return objects.empty(); });
+}
+
+CascadeStage CascadeStage::custom(std::function<void(CascadeContext &)> handler) {
+    CascadeStage stage{};
+    stage.type = Type::kCustom;
+    stage.handler = std::move(handler);
+    return stage;
+}
+
+// 整帧检测缓存
+struct DetectCache {
+    bool valid{false};
+    std::vector<AlgoObject> objects;
+    uint32_t frames{0};// 检测后复用帧数
+    std::chrono::steady_clock::time_point time;
+
+    std::vector<cv::Rect> probe_rects;// 最近检出的目标框, 未检出时保留
+    std::vector<cv::Scalar> probe_means;
+};
+
+// 单个跟踪目标的裁剪检测缓存
+struct CropCacheEntry {
+    std::vector<AlgoObject> objects;// 裁剪区域坐标
+    std::string signature;          // 检测结果标签, 用于判断是否稳定
+    uint32_t stable{0};             // 连续一致次数
+    uint32_t reused{0};             // 上次检测后复用帧数
+    cv::Rect rect;                  // 上次检测时的目标框
+    uint64_t last_frame{0};
+};
+
+struct CropCache {
+    uint64_t frame{0};
+    std::map<int, CropCacheEntry> entries;// 按跟踪ID
+};
+
+constexpr uint64_t kCropCacheExpireFrames = 30;// 跟踪目标消失超过N帧后清除缓存
+
+// 运动门控状态
+struct MotionGate {
+    bool valid{false};
+    cv::Mat reference;              // 上次检测帧 (缩小灰度图)
+    std::vector<AlgoObject> objects;// 上次检测结果
+    uint32_t skipped{0};            // 连续跳过帧数
+};
+
+// 检测区域掩码, 按 1/(2^kZoneMaskShift) 分辨率栅格化
+struct ZoneMask {
+    uint64_t version{0};
+    cv::Size size;// 对应的原图尺寸
+    cv::Mat mask; // 区域内为 255, 未设置区域时为空
+    ZoneAnchor anchor{ZoneAnchor::kBottomCenter};
+};
+
+constexpr int kZoneMaskShift = 2;
+
+struct CascadeStream {
+    std::mutex mutex;// 各阶段异步回调线程不同, 跟踪/统计需加锁
+    std::unique_ptr<BYTETracker> tracker;
+    std::unique_ptr<SequenceStatistic> sequence_statistic;
+    std::unique_ptr<ReorderBuffer> reorder_buffer;// 有序输出时创建, 之后不再替换
+    std::map<size_t, DetectCache> detect_caches;  // 按阶段序号
+    std::map<size_t, CropCache> crop_caches;      // 按阶段序号
+    MotionGate motion_gate;
+    ZoneMask zone_mask;
+};
+
+// 帧差用缩小灰度图
+static cv::Mat motion_image(const cv::Mat &image, const uint32_t width) {
+    cv::Mat resized_image;
+    auto height = std::max<int>(1, image.rows * width / std::max(image.cols, 1));
+    cv::resize(image, resized_image, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+
+    if (resized_image.channels() == 1) { return resized_image; }
+
+    cv::Mat gray_image;
+    cv::cvtColor(resized_image, gray_image, cv::COLOR_BGR2GRAY);
+    return gray_image;
+}
+
+// 归一化多边形转为掩码坐标
+static std::vector<std::vector<cv::Point>> zone_polygons(const std::vector<std::vector<cv::Point2f>> &polygons,
+                                                         const int width, const int height) {
+    std::vector<std::vector<cv::Point>> points;
+    for (const auto &polygon : polygons) {
+        if (polygon.size() < 3) { continue; }
+        points.emplace_back();
+        for (const auto &point : polygon) {
+            points.back().emplace_back(cv::Point(std::lround(point.x * width), std::lround(point.y * height)));
+        }
+    }
+    return points;
+}
+
+// 目标框内像素均值
+static std::vector<cv::Scalar> probe_means(const cv::Mat &image, const std::vector<cv::Rect> &rects) {
+    std::vector<cv::Scalar> means;
+    for (const auto &rect : rects) {
+        auto roi = rect & cv::Rect{0, 0, image.cols, image.rows};
+        means.emplace_back(roi.area() > 0 ? cv::mean(image(roi)) : cv::Scalar{});
+    }
+    return means;
+}
+
+// 按置信度+目标框面积排序, 保留前 max_number 个目标, 返回截断数
+static size_t sort_and_truncate(std::vector<AlgoObject> &objects, const size_t max_number) {
+    std::sort(objects.begin(), objects.end(), [](const AlgoObject &item1, const AlgoObject &item2) {
+        return item1.score > item2.score && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
+    });
+
+    if (objects.size() <= max_number) { return 0; }
+
+    auto truncated = objects.size() - max_number;
+    objects.resize(max_number);
+    return truncated;
+}
+
+// 追踪已结束的阶段, 未开始追踪时直接返回
+static void trace_stage(const char *stage, const CascadeContext &context,
+                        const std::chrono::steady_clock::time_point &begin, const char *detail = nullptr,
+                        const bool async = false) {
+    if (!TraceBuffer::enabled()) { return; }
+    TraceBuffer::instance().record(TraceEvent{stage, detail, context.stream_id, context.frame->image_id(),
+                                              TraceBuffer::thread_id(), async, begin,
+                                              std::chrono::steady_clock::now()});
+}
+
+Cascade::Cascade(const std::string &name, const std::vector<CascadeStage> &stages, const float statistics_interval,
+                 const float statistics_threshold)
+    : name_(name), stages_(stages), statistics_interval_(statistics_interval),
+      statistics_threshold_(statistics_threshold) {
+    gddeploy::gddeploy_init("");
+
+    // 阶段引用的模型数
+    for (const auto &stage : stages_) {
+        model_number_ = std::max<size_t>(model_number_, stage.model_index + 1);
+        model_number_ = std::max<size_t>(model_number_, stage.crop_limit_model + 1);
+    }
+
+    metrics_ = std::make_unique<CascadeMetrics>(model_number_);
+}
+
+Cascade::~Cascade() {
+    // 模型可能被其他算法共享, 只等待本实例提交的帧完成; 回调线程的收尾由模型最后一个句柄释放时等待 (见 ModelRegistry)
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    pending_cv_.wait(lock, [this] { return pending_frames_ == 0 && queued_frames_.empty(); });
+    lock.unlock();
+
+    // 在途帧已全部完成并交付, 停止超时检查线程 (其回调使用本实例成员)
+    {
+        std::lock_guard<std::mutex> reorder_lock(reorder_mutex_);
+        reorder_stop_ = true;
+        reorder_cv_.notify_all();
+    }
+    if (reorder_thread_.joinable()) { reorder_thread_.join(); }
+}
+
+bool Cascade::load_models(const std::vector<ModelConfig> &models) {
+    if (models.size() != model_number_) {
+        spdlog::error("{} requires exactly {} models", name_, model_number_);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    model_impls_.clear();
+    trace_names_.clear();
+
+    model_configs_ = models;
+    for (const auto &model : models) {
+        auto algo_impl = ModelRegistry::instance().acquire(model);
+        if (!algo_impl) {
+            spdlog::error("Failed to load model: {} - {}", model.name, model.path);
+            return false;
+        }
+        model_impls_.emplace_back(std::move(algo_impl));
+        trace_names_.emplace_back(TraceBuffer::instance().intern(model.name));
+    }
+
+    return true;
+}
+
+void Cascade::async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                          InferCallback infer_callback) {
+    async_infer(stream_id, std::make_shared<FrameContext>(image_id, image), infer_callback);
+}
+
+void Cascade::async_infer(const int stream_id, const FrameContextPtr &frame, InferCallback infer_callback) {
+    auto context = create_context(stream_id, frame);
+
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    if (flow_control_.ordered_delivery) {
+        auto timeout = std::chrono::milliseconds(flow_control_.reorder_timeout);
+        lock.unlock();
+
+        // 提交顺序登记, 登记时可能释放已完成的帧, 不能持锁
+        {
+            std::lock_guard<std::mutex> stream_lock(context->stream->mutex);
+            if (!context->stream->reorder_buffer) {
+                context->stream->reorder_buffer = std::make_unique<ReorderBuffer>(timeout);
+            }
+        }
+        context->sequence = context->stream->reorder_buffer->push(frame->image_id());
+        notify_reorder_timer();
+
+        lock.lock();
+    }
+
+    const auto max_inflight = flow_control_.max_inflight;
+    if (max_inflight == 0 || (pending_frames_ < max_inflight && queued_frames_.empty())) {
+        overload_frames_ = 0;
+        pending_frames_++;
+        lock.unlock();
+        return start_async(context, infer_callback);
+    }
+
+    // 过载, 按策略排队或丢帧
+    if (flow_control_.policy == OverflowPolicy::kKeepNth
+        && overload_frames_++ % std::max<uint32_t>(flow_control_.keep_interval, 1) != 0) {
+        lock.unlock();
+        return drop_frame(context);
+    }
+
+    if (queued_frames_.size() < flow_control_.max_queue) {
+        queued_frames_.emplace_back(context, infer_callback);
+        return;
+    }
+
+    switch (flow_control_.policy) {
+        case OverflowPolicy::kBlock: {
+            pending_cv_.wait(lock, [this, max_inflight] {
+                return queued_frames_.size() < flow_control_.max_queue
+                    || (pending_frames_ < max_inflight && queued_frames_.empty());
+            });
+            if (queued_frames_.empty() && pending_frames_ < max_inflight) {
+                pending_frames_++;
+                lock.unlock();
+                return start_async(context, infer_callback);
+            }
+            queued_frames_.emplace_back(context, infer_callback);
+            return;
+        }
+        case OverflowPolicy::kDropOldest:
+        case OverflowPolicy::kKeepNth: {
+            if (queued_frames_.empty()) { break; }
+            auto oldest = queued_frames_.front().first;
+            queued_frames_.pop_front();
+            queued_frames_.emplace_back(context, infer_callback);
+            lock.unlock();
+            return drop_frame(oldest);
+        }
+        case OverflowPolicy::kDropNewest: break;
+    }
+
+    lock.unlock();
+    drop_frame(context);
+}
+
+void Cascade::start_async(const ContextPtr &context, const InferCallback &infer_callback) {
+    run_stages(context, 0, true, [this, infer_callback](const ContextPtr &context) {
+        if (!context->success) { metrics_->failed_frames.fetch_add(1, std::memory_order_relaxed); }
+
+        auto deliver = [this, context, infer_callback]() {
+            metrics_->frame.record(std::chrono::steady_clock::now() - context->start);
+            trace_stage("frame", *context, context->start, nullptr, true);
+            if (infer_callback) {
+                metrics_->callbacks.fetch_add(1, std::memory_order_relaxed);
+                infer_callback(context->frame->image_id(), context->frame->image(), context->objects);
+            }
+        };
+
+        if (context->sequence == 0) {
+            deliver();
+        } else if (!context->stream->reorder_buffer->complete(context->frame->image_id(), context->sequence,
+                                                               deliver)) {
+            // 等待超时已被跳过, 结果丢弃
+            drop_frame(context);
+        }
+
+        finish_async();
+    });
+}
+
+void Cascade::notify_reorder_timer() {
+    std::lock_guard<std::mutex> lock(reorder_mutex_);
+    if (reorder_stop_) { return; }
+    if (!reorder_thread_.joinable()) { reorder_thread_ = std::thread(&Cascade::run_reorder_timer, this); }
+    reorder_notified_ = true;
+    reorder_cv_.notify_all();
+}
+
+void Cascade::run_reorder_timer() {
+    auto ordered_streams = [this]() {
+        std::vector<std::shared_ptr<CascadeStream>> streams;
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        for (const auto &item : streams_) {
+            if (item.second->reorder_buffer) { streams.emplace_back(item.second); }
+        }
+        return streams;
+    };
+
+    while (true) {
+        // 最近的队首超时时刻
+        bool waiting = false;
+        std::chrono::steady_clock::time_point deadline;
+        for (const auto &stream : ordered_streams()) {
+            std::chrono::steady_clock::time_point head_deadline;
+            if (stream->reorder_buffer->head_deadline(head_deadline) && (!waiting || head_deadline < deadline)) {
+                deadline = head_deadline;
+                waiting = true;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(reorder_mutex_);
+            if (!reorder_notified_ && !reorder_stop_) {
+                if (waiting) {
+                    reorder_cv_.wait_until(lock, deadline);
+                } else {
+                    reorder_cv_.wait(lock);
+                }
+            }
+            if (reorder_stop_) { break; }
+            reorder_notified_ = false;
+        }
+
+        // 回调可能再次提交帧, 不能持有 reorder_mutex_
+        for (const auto &stream : ordered_streams()) { stream->reorder_buffer->expire(); }
+    }
+}
+
+void Cascade::finish_async() {
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    pending_frames_--;
+
+    // 提交排队帧, 在途数不变
+    if (!queued_frames_.empty() && (flow_control_.max_inflight == 0 || pending_frames_ < flow_control_.max_inflight)) {
+        auto next_frame = std::move(queued_frames_.front());
+        queued_frames_.pop_front();
+        pending_frames_++;
+        pending_cv_.notify_all();
+        lock.unlock();
+        return start_async(next_frame.first, next_frame.second);
+    }
+
+    pending_cv_.notify_all();
+}
+
+void Cascade::run_async(const int stream_id, const FrameContextPtr &frame, FrameDone frame_done) {
+    auto context = create_context(stream_id, frame);
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_frames_++;
+    }
+
+    run_stages(context, 0, true, [this, frame_done](const ContextPtr &context) {
+        metrics_->frame.record(std::chrono::steady_clock::now() - context->start);
+        trace_stage("frame", *context, context->start, nullptr, true);
+        if (!context->success) { metrics_->failed_frames.fetch_add(1, std::memory_order_relaxed); }
+
+        if (frame_done) {
+            metrics_->callbacks.fetch_add(1, std::memory_order_relaxed);
+            frame_done(context->success, context->objects);
+        }
+
+        finish_async();
+    });
+}
+
+void Cascade::drop_frame(const ContextPtr &context) {
+    std::function<void(const int64_t)> drop_callback;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        dropped_frames_++;
+        drop_callback = flow_control_.drop_callback;
+    }
+
+    if (context->sequence != 0) {
+        context->stream->reorder_buffer->skip(context->frame->image_id(), context->sequence);
+    }
+
+    if (drop_callback) { drop_callback(context->frame->image_id()); }
+}
+
+bool Cascade::sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                         std::vector<AlgoObject> &objects) {
+    return sync_infer(stream_id, std::make_shared<FrameContext>(image_id, image), objects);
+}
+
+bool Cascade::sync_infer(const int stream_id, const FrameContextPtr &frame, std::vector<AlgoObject> &objects) {
+    auto context = create_context(stream_id, frame);
+
+    // 同步模式下各阶段在当前线程内依次完成
+    run_stages(context, 0, false, [this, &objects](const ContextPtr &context) {
+        metrics_->frame.record(std::chrono::steady_clock::now() - context->start);
+        trace_stage("frame", *context, context->start);
+        if (!context->success) { metrics_->failed_frames.fetch_add(1, std::memory_order_relaxed); }
+        objects = context->objects;
+    });
+
+    return context->success;
+}
+
+void Cascade::release_stream(const int stream_id) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    streams_.erase(stream_id);
+}
+
+void Cascade::set_flow_control(const FlowControlConfig &config) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        flow_control_ = config;
+        pending_cv_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    for (auto &item : streams_) {
+        std::lock_guard<std::mutex> stream_lock(item.second->mutex);
+        if (item.second->reorder_buffer) {
+            item.second->reorder_buffer->set_timeout(std::chrono::milliseconds(config.reorder_timeout));
+        }
+    }
+    notify_reorder_timer();
+}
+
+uint64_t Cascade::dropped_frames() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return dropped_frames_;
+}
+
+void Cascade::set_motion_gate(const MotionGateConfig &config) { motion_gate_ = config; }
+
+void Cascade::set_zone(const ZoneConfig &config) {
+    std::lock_guard<std::mutex> lock(zone_mutex_);
+    zone_ = config;
+    zone_version_++;
+}
+
+void Cascade::set_zone(const int stream_id, const ZoneConfig &config) {
+    std::lock_guard<std::mutex> lock(zone_mutex_);
+    stream_zones_[stream_id] = config;
+    zone_version_++;
+}
+
+AlgoMetrics Cascade::get_metrics() {
+    AlgoMetrics metrics;
+    metrics.frames = metrics_->frames.load(std::memory_order_relaxed);
+    metrics.failed_frames = metrics_->failed_frames.load(std::memory_order_relaxed);
+    metrics.dropped_frames = dropped_frames();
+    metrics.callbacks = metrics_->callbacks.load(std::memory_order_relaxed);
+    metrics.crops = metrics_->crops.load(std::memory_order_relaxed);
+    metrics.truncated_crops = metrics_->truncated_crops.load(std::memory_order_relaxed);
+    metrics.cached_detections = metrics_->cached_detections.load(std::memory_order_relaxed);
+    metrics.cached_crops = metrics_->cached_crops.load(std::memory_order_relaxed);
+    metrics.motion_skipped = metrics_->motion_skipped.load(std::memory_order_relaxed);
+    metrics.zone_filtered = metrics_->zone_filtered.load(std::memory_order_relaxed);
+
+    metrics.frame = metrics_->frame.snapshot();
+    metrics.convert = metrics_->convert.snapshot();
+    metrics.parse = metrics_->parse.snapshot();
+    metrics.track = metrics_->track.snapshot();
+    metrics.cover_merge = metrics_->cover_merge.snapshot();
+    metrics.statistic = metrics_->statistic.snapshot();
+
+    // 模型未加载时按序号命名
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    for (size_t i = 0; i < model_number_; i++) {
+        auto name = i < model_configs_.size() ? model_configs_[i].name : std::to_string(i);
+        metrics.models[name] = metrics_->models[i].snapshot();
+    }
+
+    return metrics;
+}
+
+Cascade::ContextPtr Cascade::create_context(const int stream_id, const FrameContextPtr &frame) {
+    auto context = std::make_shared<CascadeContext>();
+    context->stream_id = stream_id;
+    context->frame = frame;
+    metrics_->frames.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    auto &stream = streams_[stream_id];
+    if (!stream) {
+        stream = std::make_shared<CascadeStream>();
+        stream->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
+        stream->sequence_statistic = std::make_unique<SequenceStatistic>(statistics_interval_, statistics_threshold_);
+    }
+    context->stream = stream;
+
+    return context;
+}
+
+void Cascade::run_stages(const ContextPtr &context, const size_t index, const bool async, const StageDone &done) {
+    for (size_t i = index; i < stages_.size(); i++) {
+        if (context->finished) { break; }
+
+        const auto &stage = stages_[i];
+        switch (stage.type) {
+            case CascadeStage::Type::kDetect: return run_detect(stage, context, i, async, done);
+            case CascadeStage::Type::kCropDetect: return run_crop_detect(stage, context, i, async, done);
+            case CascadeStage::Type::kTrack: {
+                std::vector<Object> objects;
+                objects.reserve(context->objects.size());
+                for (const auto &item : context->objects) {
+                    objects.push_back(Object{
+                        .target_id = 0,
+                        .class_id = item.class_id,
+                        .prob = item.score,
+                        .rect = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width,
+                                 (float)item.rect.height},
+                        .label_id = STrack::label_to_id(item.label),
+                    });
+                }
+
+                std::lock_guard<std::mutex> lock(context->stream->mutex);
+                ScopedLatency latency(metrics_->track);
+                TraceSpan span("track", context->stream_id, context->frame->image_id());
+                auto &tracker = context->stream->tracker;
+                // 输入来自被跳过的门控检测时, 上次结果已更新过跟踪器, 只做预测
+                const auto &tracks = context->motion_skipped ? tracker->predict() : tracker->update(objects);
+                context->objects.clear();
+                for (auto &item : tracks) {
+                    context->objects.emplace_back(
+                        AlgoObject{item.target_id, item.class_id, item.label_name(), item.score,
+                                   cv::Rect{(int)item.tlwh[0], (int)item.tlwh[1], (int)item.tlwh[2], (int)item.tlwh[3]},
+                                   item.track_id});
+                }
+                break;
+            }
+            case CascadeStage::Type::kTopK: {
+                auto truncated = sort_and_truncate(context->objects, model_configs_[stage.model_index].max_crop_number);
+                metrics_->truncated_crops.fetch_add(truncated, std::memory_order_relaxed);
+                break;
+            }
+            case CascadeStage::Type::kFilter: {
+                std::vector<AlgoObject> objects;
+                for (const auto &item : context->objects) {
+                    if (stage.predicate(item)) { objects.emplace_back(item); }
+                }
+                context->objects = std::move(objects);
+                break;
+            }
+            case CascadeStage::Type::kZone: filter_zone(context); break;
+            case CascadeStage::Type::kStatistic: {
+                std::lock_guard<std::mutex> lock(context->stream->mutex);
+                ScopedLatency latency(metrics_->statistic);
+                TraceSpan span("statistic", context->stream_id, context->frame->image_id());
+                context->objects = context->stream->sequence_statistic->update(context->objects);
+                break;
+            }
+            case CascadeStage::Type::kFinishIf:
+                if (stage.condition(context->objects)) { context->finished = true; }
+                break;
+            case CascadeStage::Type::kCustom: stage.handler(*context); break;
+        }
+    }
+
+    done(context);
+}
+
+void Cascade::submit(const int model_index, const ContextPtr &context, const gddeploy::PackagePtr &in_package,
+                     const bool async, InferDone on_result) {
+    auto tag = InferTag{context->stream_id, context->frame->image_id()};
+    auto start = std::chrono::steady_clock::now();
+    if (async) {
+        model_impls_[model_index]->infer_async(
+            tag, in_package,
+            [this, model_index, context, start, on_result](const InferTag &, bool success,
+                                                           const gddeploy::PackagePtr &data) {
+                metrics_->models[model_index].record(std::chrono::steady_clock::now() - start);
+                trace_stage("infer", *context, start, trace_names_[model_index], true);
+                on_result(success, data);
+            });
+    } else {
+        auto out_package = gddeploy::Package::Create(in_package->data.size());
+        auto success = model_impls_[model_index]->infer_sync(tag, in_package, out_package);
+        metrics_->models[model_index].record(std::chrono::steady_clock::now() - start);
+        trace_stage("infer", *context, start, trace_names_[model_index]);
+        on_result(success, out_package);
+    }
+}
+
+bool Cascade::check_motion_gate(const ContextPtr &context) {
+    auto image = motion_image(context->frame->image(), std::max<uint32_t>(motion_gate_.width, 1));
+
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &gate = context->stream->motion_gate;
+    if (gate.valid && gate.reference.cols == image.cols && gate.reference.rows == image.rows
+        && (motion_gate_.max_skip == 0 || gate.skipped < motion_gate_.max_skip)) {
+        // 帧差 (OpenCV 向量化实现)
+        cv::Mat diff;
+        cv::absdiff(image, gate.reference, diff);
+        cv::threshold(diff, diff, motion_gate_.pixel_threshold, 255, cv::THRESH_BINARY);
+        auto changed = cv::countNonZero(diff);
+        if (changed <= motion_gate_.area_threshold * diff.total()) {
+            gate.skipped++;
+            context->objects = gate.objects;
+            context->motion_skipped = true;
+            return true;
+        }
+    }
+
+    // 运动或超过最大跳过帧数, 以本帧为参考重新检测
+    gate.reference = image;
+    gate.skipped = 0;
+    return false;
+}
+
+void Cascade::store_motion_gate(const ContextPtr &context) {
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &gate = context->stream->motion_gate;
+    gate.valid = true;
+    gate.objects = context->objects;
+}
+
+ZoneMask Cascade::zone_mask(const ContextPtr &context) {
+    const auto &image = context->frame->image();
+
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &zone_mask = context->stream->zone_mask;
+
+    ZoneConfig config;
+    {
+        std::lock_guard<std::mutex> zone_lock(zone_mutex_);
+        if (zone_mask.version == zone_version_ && zone_mask.size.width == image.cols
+            && zone_mask.size.height == image.rows) {
+            return zone_mask;
+        }
+
+        auto iter = stream_zones_.find(context->stream_id);
+        config = iter != stream_zones_.end() ? iter->second : zone_;
+        zone_mask.version = zone_version_;
+    }
+
+    zone_mask.size = cv::Size(image.cols, image.rows);
+    zone_mask.anchor = config.anchor;
+    zone_mask.mask = cv::Mat();
+    if (config.include.empty() && config.exclude.empty()) { return zone_mask; }
+
+    // 栅格化, 之后每个目标只需查表
+    int width = std::max(image.cols >> kZoneMaskShift, 1);
+    int height = std::max(image.rows >> kZoneMaskShift, 1);
+    cv::Mat mask(height, width, CV_8UC1, cv::Scalar(config.include.empty() ? 255 : 0));
+    if (!config.include.empty()) { cv::fillPoly(mask, zone_polygons(config.include, width, height), cv::Scalar(255)); }
+    if (!config.exclude.empty()) { cv::fillPoly(mask, zone_polygons(config.exclude, width, height), cv::Scalar(0)); }
+    zone_mask.mask = mask;
+
+    return zone_mask;
+}
+
+void Cascade::filter_zone(const ContextPtr &context) {
+    auto zone = zone_mask(context);
+    if (zone.mask.empty()) { return; }
+
+    std::vector<AlgoObject> objects;
+    for (const auto &item : context->objects) {
+        // 锚点所在掩码像素
+        int x = item.rect.x + item.rect.width / 2;
+        int y = item.rect.y + (zone.anchor == ZoneAnchor::kBottomCenter ? item.rect.height : item.rect.height / 2);
+        x = std::min(std::max(x, 0) >> kZoneMaskShift, zone.mask.cols - 1);
+        y = std::min(std::max(y, 0) >> kZoneMaskShift, zone.mask.rows - 1);
+        if (zone.mask.at<uint8_t>(y, x) > 0) { objects.emplace_back(item); }
+    }
+
+    metrics_->zone_filtered.fetch_add(context->objects.size() - objects.size(), std::memory_order_relaxed);
+    context->objects = std::move(objects);
+}
+
+bool Cascade::load_detect_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index) {
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &cache = context->stream->detect_caches[index];
+    if (!cache.valid || cache.frames + 1 >= stage.cache.max_frames) { return false; }
+
+    if (stage.cache.max_interval > 0
+        && std::chrono::steady_clock::now() - cache.time >= std::chrono::milliseconds(stage.cache.max_interval)) {
+        return false;
+    }
+
+    // 目标框内画面变化 (如灯亮/灭) 时重新检测
+    if (stage.cache.probe_threshold > 0) {
+        auto means = probe_means(context->frame->image(), cache.probe_rects);
+        for (size_t i = 0; i < means.size(); i++) {
+            for (int c = 0; c < 4; c++) {
+                if (std::abs(means[i][c] - cache.probe_means[i][c]) > stage.cache.probe_threshold) { return false; }
+            }
+        }
+    }
+
+    cache.frames++;
+    context->objects = cache.objects;
+    return true;
+}
+
+void Cascade::store_detect_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index) {
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &cache = context->stream->detect_caches[index];
+    cache.valid = true;
+    cache.objects = context->objects;
+    cache.frames = 0;
+    cache.time = std::chrono::steady_clock::now();
+
+    if (stage.cache.probe_threshold > 0) {
+        if (!context->objects.empty()) {
+            cache.probe_rects.clear();
+            for (const auto &item : context->objects) { cache.probe_rects.emplace_back(item.rect); }
+        }
+        cache.probe_means = probe_means(context->frame->image(), cache.probe_rects);
+    }
+}
+
+// 目标框偏移/缩放超过阈值
+static bool rect_changed(const cv::Rect &rect1, const cv::Rect &rect2, const CropCacheConfig &config) {
+    if (rect1.width <= 0 || rect1.height <= 0) { return true; }
+
+    float shift_x = std::abs((rect2.x + rect2.width / 2.0f) - (rect1.x + rect1.width / 2.0f)) / rect1.width;
+    float shift_y = std::abs((rect2.y + rect2.height / 2.0f) - (rect1.y + rect1.height / 2.0f)) / rect1.height;
+    float scale_w = std::abs((float)rect2.width / rect1.width - 1);
+    float scale_h = std::abs((float)rect2.height / rect1.height - 1);
+    return std::max(shift_x, shift_y) > config.max_shift || std::max(scale_w, scale_h) > config.max_scale;
+}
+
+// 裁剪检测结果的标签集合
+static std::string crop_signature(const std::vector<AlgoObject> &objects) {
+    std::vector<std::string> labels;
+    for (const auto &item : objects) { labels.emplace_back(item.label); }
+    std::sort(labels.begin(), labels.end());
+
+    std::string signature;
+    for (const auto &label : labels) { signature += label + ","; }
+    return signature;
+}
+
+std::vector<size_t> Cascade::load_crop_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index,
+                                             std::vector<std::vector<AlgoObject>> &crop_results) {
+    const auto &config = stage.crop_cache;
+    std::vector<size_t> infer_indices;
+
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &cache = context->stream->crop_caches[index];
+    cache.frame++;
+
+    // 清除已消失的跟踪目标
+    for (auto iter = cache.entries.begin(); iter != cache.entries.end();) {
+        if (cache.frame - iter->second.last_frame > kCropCacheExpireFrames) {
+            iter = cache.entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    for (size_t i = 0; i < context->objects.size(); i++) {
+        const auto &object = context->objects[i];
+        auto iter = cache.entries.find(object.track_id);
+        if (iter != cache.entries.end()) {
+            auto &entry = iter->second;
+            entry.last_frame = cache.frame;
+            if (entry.stable >= config.stable_count
+                && (config.recheck_frames == 0 || entry.reused < config.recheck_frames)
+                && !rect_changed(entry.rect, object.rect, config)) {
+                entry.reused++;
+                crop_results[i] = entry.objects;
+                continue;
+            }
+        }
+        infer_indices.emplace_back(i);
+    }
+
+    metrics_->cached_crops.fetch_add(context->objects.size() - infer_indices.size(), std::memory_order_relaxed);
+    return infer_indices;
+}
+
+void Cascade::store_crop_cache(const ContextPtr &context, const size_t index, const std::vector<size_t> &infer_indices,
+                               const std::vector<std::vector<AlgoObject>> &crop_results) {
+    std::lock_guard<std::mutex> lock(context->stream->mutex);
+    auto &cache = context->stream->crop_caches[index];
+    for (auto i : infer_indices) {
+        const auto &object = context->objects[i];
+        auto &entry = cache.entries[object.track_id];
+
+        // 结果变化时重新累计
+        auto signature = crop_signature(crop_results[i]);
+        entry.stable = entry.stable > 0 && entry.signature == signature ? entry.stable + 1 : 1;
+        entry.signature = signature;
+        entry.objects = crop_results[i];
+        entry.reused = 0;
+        entry.rect = object.rect;
+        entry.last_frame = cache.frame;
+    }
+}
+
+void Cascade::run_detect(const CascadeStage &stage, const ContextPtr &context, const size_t index, const bool async,
+                         const StageDone &done) {
+    const bool gated = stage.motion_gate && motion_gate_.enable;
+    if (gated && check_motion_gate(context)) {
+        metrics_->motion_skipped.fetch_add(1, std::memory_order_relaxed);
+        return run_stages(context, index + 1, async, done);
+    }
+    // 本阶段输出替换当前目标, 后续跟踪按新结果更新
+    context->motion_skipped = false;
+
+    const bool cached = stage.cache.max_frames > 1;
+    if (cached && load_detect_cache(stage, context, index)) {
+        metrics_->cached_detections.fetch_add(1, std::memory_order_relaxed);
+        return run_stages(context, index + 1, async, done);
+    }
+
+    const auto &model_config = model_configs_[stage.model_index];
+
+    auto in_package = gddeploy::Package::Create(1);
+    {
+        ScopedLatency latency(metrics_->convert);
+        TraceSpan span("convert", context->stream_id, context->frame->image_id());
+        in_package->data[0]->Set(context->frame->surface());
+    }
+    auto key = InferKey{model_impls_[stage.model_index].get(), -1, -1};
+    if (!stage.filter.model_threshold) {
+        in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{model_config.threshold, model_config.nms_threshold});
+        key = InferKey{model_impls_[stage.model_index].get(), model_config.threshold, model_config.nms_threshold};
+    }
+
+    // 同一帧上其他算法已用相同模型+参数推理时直接复用结果, 按各自的过滤条件解析
+    context->frame->share_infer(
+        key,
+        [this, &stage, context, in_package, async](const InferDone &on_result) {
+            submit(stage.model_index, context, in_package, async, on_result);
+        },
+        [this, &stage, context, index, async, done, gated, cached](bool success, const gddeploy::PackagePtr &data) {
+            if (!success) {
+                context->objects.clear();
+                context->finished = true;
+                context->success = false;
+                return done(context);
+            }
+
+            {
+                ScopedLatency latency(metrics_->parse);
+                TraceSpan span("parse", context->stream_id, context->frame->image_id());
+                context->objects = parse_infer_result(data, 0, stage.model_index, stage.filter);
+            }
+            if (gated) { store_motion_gate(context); }
+            if (cached) { store_detect_cache(stage, context, index); }
+            run_stages(context, index + 1, async, done);
+        });
+}
+
+void Cascade::run_crop_detect(const CascadeStage &stage, const ContextPtr &context, const size_t index,
+                              const bool async, const StageDone &done) {
+    if (context->objects.empty()) { return run_stages(context, index + 1, async, done); }
+
+    const auto &model_config = model_configs_[stage.model_index];
+    const auto &image = context->frame->image();
+
+    // 裁剪区域, 缓存命中的跟踪目标不再检测
+    auto crop_rects = std::make_shared<std::vector<cv::Rect>>();
+    auto crop_results = std::make_shared<std::vector<std::vector<AlgoObject>>>(context->objects.size());
+    for (const auto &object : context->objects) {
+        crop_rects->emplace_back(scale_crop_rect(image.cols, image.rows, object.rect, model_config.crop_scale_factor));
+    }
+
+    const bool cached = stage.crop_cache.stable_count > 0;
+    auto infer_indices = std::make_shared<std::vector<size_t>>();
+    if (cached) {
+        *infer_indices = load_crop_cache(stage, context, index, *crop_results);
+    } else {
+        for (size_t i = 0; i < context->objects.size(); i++) { infer_indices->emplace_back(i); }
+    }
+
+    if (infer_indices->empty()) {
+        merge_crop_results(stage, context, *crop_rects, *crop_results);
+        return run_stages(context, index + 1, async, done);
+    }
+
+    // 裁剪目标
+    auto in_package = gddeploy::Package::Create(infer_indices->size());
+    metrics_->crops.fetch_add(infer_indices->size(), std::memory_order_relaxed);
+    auto convert_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < infer_indices->size(); i++) {
+        in_package->data[i]->Set(context->frame->crop_surface((*crop_rects)[(*infer_indices)[i]]));
+        if (!stage.filter.model_threshold) {
+            in_package->data[i]->SetAlgParam(
+                gddeploy::AlgDetectParam{model_config.threshold, model_config.nms_threshold});
+        }
+    }
+    metrics_->convert.record(std::chrono::steady_clock::now() - convert_start);
+    trace_stage("convert", *context, convert_start);
+
+    // 批量检测
+    submit(stage.model_index, context, in_package, async,
+           [this, &stage, context, index, async, done, cached, crop_rects, crop_results,
+            infer_indices](bool success, const gddeploy::PackagePtr &data) {
+               if (!success) {
+                   context->objects.clear();
+                   context->finished = true;
+                   context->success = false;
+                   return done(context);
+               }
+
+               auto parse_start = std::chrono::steady_clock::now();
+               for (size_t i = 0; i < infer_indices->size(); i++) {
+                   (*crop_results)[(*infer_indices)[i]] = parse_infer_result(data, i, stage.model_index, stage.filter);
+               }
+               if (cached) { store_crop_cache(context, index, *infer_indices, *crop_results); }
+               metrics_->parse.record(std::chrono::steady_clock::now() - parse_start);
+               trace_stage("parse", *context, parse_start);
+
+               // 合并不计入解析耗时, 多目标重叠合并单独计入 cover_merge
+               merge_crop_results(stage, context, *crop_rects, *crop_results);
+               run_stages(context, index + 1, async, done);
+           });
+}
+
+void Cascade::merge_crop_results(const CascadeStage &stage, const ContextPtr &context,
+                                 const std::vector<cv::Rect> &crop_rects,
+                                 const std::vector<std::vector<AlgoObject>> &crop_results) {
+    std::vector<AlgoObject> match_objects;
+    for (size_t i = 0; i < crop_rects.size(); i++) {
+        if (stage.crop_merge == CropMerge::kAbsent) {
+            if (crop_results[i].empty()) { match_objects.emplace_back(context->objects[i]); }
+            continue;
+        }
+
+        // 映射回原图 & 赋值跟踪ID
+        auto infer_objects = crop_results[i];
+        for (auto &obj : infer_objects) {
+            obj.rect.x += crop_rects[i].x;
+            obj.rect.y += crop_rects[i].y;
+            obj.track_id = context->objects[i].track_id;
+        }
+
+        if (stage.crop_limit_model >= 0) {
+            auto truncated = sort_and_truncate(infer_objects, model_configs_[stage.crop_limit_model].max_crop_number);
+            metrics_->truncated_crops.fetch_add(truncated, std::memory_order_relaxed);
+        }
+
+        // 各裁剪区域的 target_id 独立编号, 只在同一区域内合并
+        if (stage.crop_merge == CropMerge::kCover) {
+            ScopedLatency latency(metrics_->cover_merge);
+            infer_objects = find_cover_objects(infer_objects, stage.include_labels, stage.exclude_labels,
+                                               stage.map_label, stage.cover_threshold);
+        }
+
+        match_objects.insert(match_objects.end(), infer_objects.begin(), infer_objects.end());
+    }
+
+    context->objects = std::move(match_objects);
+}
+
+std::vector<AlgoObject> Cascade::parse_infer_result(const gddeploy::PackagePtr &package, const size_t index,
+                                                    const int model_index, const ObjectFilter &filter) {
+    std::vector<AlgoObject> objects;
+    if (index >= package->data.size() || !package->data[index]->HasMetaValue()) { return objects; }
+
+    const auto &model_config = model_configs_[model_index];
+    const auto &labels = filter.model_labels ? model_config.labels : filter.labels;
+    const bool match_all = !filter.model_labels && filter.labels.empty();
+
+    auto infer_result = package->data[index]->GetMetaData<gddeploy::InferResult>();
+    for (auto result_type : infer_result.result_type) {
+        if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
+            for (const auto &item : infer_result.detect_result.detect_imgs) {
+                int target_id = 1;
+                for (auto &obj : item.detect_objs) {
+                    if (!match_all && labels.count(obj.label) == 0) { continue; }
+                    if (filter.exclude_labels.count(obj.label) > 0) { continue; }
+                    if (filter.model_threshold && obj.score < model_config.threshold) { continue; }
+
+                    objects.emplace_back(
+                        AlgoObject{target_id++, obj.class_id, obj.label, obj.score,
+                                   cv::Rect{(int)obj.bbox.x, (int)obj.bbox.y, (int)obj.bbox.w, (int)obj.bbox.h}, 0});
+                }
+            }
+        }
+    }
+
+    return objects;
+}
+
+}// namespace gddi
@@ -0,0 +1,366 @@
+/**
+ * @file cascade.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 多阶段级联推理引擎, 算法只需描述阶段, 由引擎统一执行
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "../frame_context.h"
+#include "metrics.h"
+#include "model_registry.h"
+#include "struct_def.h"
+#include <api/infer_api.h>
+#include <core/result_def.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BYTETracker;
+
+namespace gddi {
+
+class SequenceStatistic;
+
+constexpr int kDefaultStreamId = 0;// 未指定视频流时使用
+
+/**
+ * @brief 单路视频流状态 (跟踪/统计), 各路独立, 模型共享
+ */
+struct CascadeStream;
+
+/**
+ * @brief 视频流检测区域掩码
+ */
+struct ZoneMask;
+
+/**
+ * @brief 检测结果过滤条件
+ */
+struct ObjectFilter {
+    bool model_labels{true};              // 按 ModelConfig::labels 保留标签
+    std::set<std::string> labels;         // model_labels 为 false 时的保留标签, 为空则保留全部
+    std::set<std::string> exclude_labels; // 排除标签
+    bool model_threshold{false};          // 解析时按 ModelConfig::threshold 过滤, 否则将阈值/NMS下发给模型
+
+    static ObjectFilter all(const bool model_threshold = false) { return ObjectFilter{false, {}, {}, model_threshold}; }
+    static ObjectFilter only(const std::set<std::string> &labels, const bool model_threshold = false) {
+        return ObjectFilter{false, labels, {}, model_threshold};
+    }
+    static ObjectFilter except(const std::set<std::string> &labels, const bool model_threshold = false) {
+        return ObjectFilter{false, {}, labels, model_threshold};
+    }
+};
+
+/**
+ * @brief 裁剪检测结果合并方式
+ */
+enum class CropMerge {
+    kOffset,// 检测结果映射回原图坐标, 继承裁剪目标的跟踪ID
+    kAbsent,// 保留裁剪区域内未检出目标的原目标
+    kCover, // 同 kOffset, 再在各裁剪区域内分别做多目标重叠合并
+};
+
+/**
+ * @brief 单帧级联状态, 在各阶段之间传递
+ */
+struct CascadeContext {
+    int stream_id{kDefaultStreamId};
+    std::shared_ptr<CascadeStream> stream;
+    uint64_t sequence{0};// 有序输出序号, 0 为未登记
+    FrameContextPtr frame;
+    std::vector<AlgoObject> objects;                             // 当前阶段目标
+    std::map<std::string, std::vector<AlgoObject>> named_objects;// 自定义阶段暂存的目标
+    bool finished{false};                                        // 提前结束, objects 即为输出
+    bool success{true};                                          // 推理是否成功
+    bool motion_skipped{false};// 当前目标来自运动门控跳过的检测阶段 (复用上次结果), 跟踪只做预测
+    std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+};
+
+struct CascadeStage {
+    enum class Type {
+        kDetect,
+        kCropDetect,
+        kTrack,
+        kTopK,
+        kFilter,
+        kZone,
+        kStatistic,
+        kFinishIf,
+        kCustom,
+    };
+
+    Type type;
+    int model_index{-1};
+    ObjectFilter filter;
+    DetectCacheConfig cache;// 整帧检测缓存
+    bool motion_gate{false};// 受运动门控的整帧检测 (一般为人员检测, 每个级联至多一个)
+
+    // 裁剪检测
+    CropMerge crop_merge{CropMerge::kOffset};
+    int crop_limit_model{-1};// 按该模型 max_crop_number 限制单个裁剪区域的结果数 (kOffset)
+    CropCacheConfig crop_cache;// 按跟踪ID缓存, 需在 track 之后
+
+    // 多目标重叠 (CropMerge::kCover)
+    std::set<std::string> include_labels;
+    std::set<std::string> exclude_labels;
+    std::string map_label;
+    float cover_threshold{0.5};
+
+    std::function<bool(const AlgoObject &)> predicate;           // kFilter
+    std::function<bool(const std::vector<AlgoObject> &)> condition;// kFinishIf
+    std::function<void(CascadeContext &)> handler;               // kCustom
+
+    /**
+     * @brief 整帧检测, 输出替换当前目标, 按 cache 配置在各视频流内复用上次结果
+     * @param motion_gate 画面静止时跳过该检测 (见 Cascade::set_motion_gate), 应标记在跟踪所用的检测阶段上
+     */
+    static CascadeStage detect(const int model_index, const ObjectFilter &filter = {},
+                               const DetectCacheConfig &cache = {}, const bool motion_gate = false);
+
+    /**
+     * @brief 按当前目标裁剪后批量检测, 按 cache 配置复用同一跟踪目标的稳定结果
+     */
+    static CascadeStage crop_detect(const int model_index, const CropMerge merge, const ObjectFilter &filter = {},
+                                    const int crop_limit_model = -1, const CropCacheConfig &cache = {});
+
+    /**
+     * @brief 生成目标跟踪ID
+     */
+    static CascadeStage track();
+
+    /**
+     * @brief 按置信度+目标框面积排序, 保留模型 max_crop_number 个目标
+     */
+    static CascadeStage top_k(const int model_index);
+
+    /**
+     * @brief 保留满足条件的目标
+     */
+    static CascadeStage filter_if(std::function<bool(const AlgoObject &)> predicate);
+
+    /**
+     * @brief 剔除检测区域外的目标 (见 Cascade::set_zone), 放在裁剪检测之前
+     */
+    static CascadeStage zone();
+
+    /**
+     * @brief 裁剪检测后多目标重叠合并, 各裁剪区域的检测结果 (target_id 各自编号) 分别合并
+     */
+    static CascadeStage crop_cover_merge(const int model_index, const ObjectFilter &filter,
+                                         const std::set<std::string> &include_labels,
+                                         const std::set<std::string> &exclude_labels, const std::string &map_label,
+                                         const float cover_threshold, const CropCacheConfig &cache = {});
+
+    /**
+     * @brief 时序统计
+     */
+    static CascadeStage statistic();
+
+    /**
+     * @brief 满足条件时结束, 输出当前目标
+     */
+    static CascadeStage finish_if(std::function<bool(const std::vector<AlgoObject> &)> condition);
+    static CascadeStage finish_if_empty();
+
+    /**
+     * @brief 自定义阶段, 可设置 finished 提前结束
+     */
+    static CascadeStage custom(std::function<void(CascadeContext &)> handler);
+};
+
+class Cascade {
+public:
+    Cascade(const std::string &name, const std::vector<CascadeStage> &stages, const float statistics_interval = 3,
+            const float statistics_threshold = 0.5);
+    ~Cascade();
+
+    bool load_models(const std::vector<ModelConfig> &models);
+
+    void async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image, InferCallback infer_callback);
+    bool sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                    std::vector<AlgoObject> &objects);
+
+    /**
+     * @brief 共享帧推理, 多个算法传入同一 FrameContext 时复用整帧检测结果
+     */
+    void async_infer(const int stream_id, const FrameContextPtr &frame, InferCallback infer_callback);
+    bool sync_infer(const int stream_id, const FrameContextPtr &frame, std::vector<AlgoObject> &objects);
+
+    using FrameDone = std::function<void(const bool, const std::vector<AlgoObject> &)>;
+
+    /**
+     * @brief 异步执行, 不经流控/有序输出, 由调用者限制在途帧数 (见 InferPipeline)
+     */
+    void run_async(const int stream_id, const FrameContextPtr &frame, FrameDone frame_done);
+
+    /**
+     * @brief 释放视频流状态, 进行中的帧仍使用原状态完成
+     */
+    void release_stream(const int stream_id);
+
+    /**
+     * @brief 设置异步推理流控
+     */
+    void set_flow_control(const FlowControlConfig &config);
+
+    /**
+     * @brief 累计丢帧数
+     */
+    uint64_t dropped_frames();
+
+    /**
+     * @brief 设置运动门控, 作用于标记了 motion_gate 的整帧检测阶段, 需在推理前调用
+     */
+    void set_motion_gate(const MotionGateConfig &config);
+
+    /**
+     * @brief 设置检测区域, 作用于 zone 阶段; 指定视频流时覆盖默认区域
+     */
+    void set_zone(const ZoneConfig &config);
+    void set_zone(const int stream_id, const ZoneConfig &config);
+
+    /**
+     * @brief 运行指标快照
+     */
+    AlgoMetrics get_metrics();
+
+protected:
+    using ContextPtr = std::shared_ptr<CascadeContext>;
+    using StageDone = std::function<void(const ContextPtr &)>;
+
+    /**
+     * @brief 创建单帧上下文, 视频流状态首次使用时创建
+     */
+    ContextPtr create_context(const int stream_id, const FrameContextPtr &frame);
+
+    /**
+     * @brief 执行异步帧, 完成后提交排队帧
+     */
+    void start_async(const ContextPtr &context, const InferCallback &infer_callback);
+
+    /**
+     * @brief 异步帧完成, 在途数减一并提交排队帧
+     */
+    void finish_async();
+
+    /**
+     * @brief 丢帧计数并回调, 调用时不持有 pending_mutex_
+     */
+    void drop_frame(const ContextPtr &context);
+
+    /**
+     * @brief 唤醒有序输出超时检查线程 (首次调用时启动), 登记新帧或超时变化后调用
+     */
+    void notify_reorder_timer();
+
+    /**
+     * @brief 等待各视频流队首帧超时, 队首卡住且之后没有新事件时释放其后已完成的帧
+     */
+    void run_reorder_timer();
+
+    /**
+     * @brief 从 index 开始执行各阶段, 推理阶段完成后在回调中继续
+     */
+    void run_stages(const ContextPtr &context, const size_t index, const bool async, const StageDone &done);
+
+    /**
+     * @brief 推理, 同步模式下直接调用后续处理
+     */
+    void submit(const int model_index, const ContextPtr &context, const gddeploy::PackagePtr &in_package,
+                const bool async, InferDone on_result);
+
+    /**
+     * @brief 画面相对上次检测无变化时取出上次结果
+     */
+    bool check_motion_gate(const ContextPtr &context);
+    void store_motion_gate(const ContextPtr &context);
+
+    /**
+     * @brief 视频流检测区域掩码, 区域或分辨率变化时重新栅格化, 未设置区域时为空
+     */
+    ZoneMask zone_mask(const ContextPtr &context);
+    void filter_zone(const ContextPtr &context);
+
+    /**
+     * @brief 检测缓存有效时取出结果
+     */
+    bool load_detect_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index);
+    void store_detect_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index);
+
+    /**
+     * @brief 取出缓存命中目标的裁剪结果, 返回需检测的目标序号
+     */
+    std::vector<size_t> load_crop_cache(const CascadeStage &stage, const ContextPtr &context, const size_t index,
+                                        std::vector<std::vector<AlgoObject>> &crop_results);
+    void store_crop_cache(const ContextPtr &context, const size_t index, const std::vector<size_t> &infer_indices,
+                          const std::vector<std::vector<AlgoObject>> &crop_results);
+
+    /**
+     * @brief 裁剪结果 (裁剪区域坐标) 按合并方式替换当前目标
+     */
+    void merge_crop_results(const CascadeStage &stage, const ContextPtr &context,
+                            const std::vector<cv::Rect> &crop_rects,
+                            const std::vector<std::vector<AlgoObject>> &crop_results);
+
+    void run_detect(const CascadeStage &stage, const ContextPtr &context, const size_t index, const bool async,
+                    const StageDone &done);
+    void run_crop_detect(const CascadeStage &stage, const ContextPtr &context, const size_t index, const bool async,
+                         const StageDone &done);
+
+    std::vector<AlgoObject> parse_infer_result(const gddeploy::PackagePtr &package, const size_t index,
+                                               const int model_index, const ObjectFilter &filter);
+
+private:
+    std::string name_;
+    std::vector<CascadeStage> stages_;
+    size_t model_number_{0};
+
+    std::unique_ptr<CascadeMetrics> metrics_;
+
+    float statistics_interval_;
+    float statistics_threshold_;
+    MotionGateConfig motion_gate_;
+
+    std::mutex zone_mutex_;
+    ZoneConfig zone_;                      // 默认检测区域
+    std::map<int, ZoneConfig> stream_zones_;// 按视频流设置的检测区域, 释放视频流后保留
+    uint64_t zone_version_{0};             // 区域变化时递增, 视频流据此重建掩码
+
+    std::mutex stream_mutex_;
+    std::map<int, std::shared_ptr<CascadeStream>> streams_;
+
+    std::mutex model_mutex_;
+    std::vector<ModelConfig> model_configs_;
+    std::vector<InferBackendPtr> model_impls_;// 进程内共享, 见 ModelRegistry
+    std::vector<const char *> trace_names_;   // 追踪中的模型名称
+
+    std::mutex pending_mutex_;
+    std::condition_variable pending_cv_;
+    size_t pending_frames_{0};// 在途异步帧数, 析构时等待
+    std::deque<std::pair<ContextPtr, InferCallback>> queued_frames_;
+    FlowControlConfig flow_control_;
+    uint64_t overload_frames_{0};// 连续过载帧数 (kKeepNth)
+    uint64_t dropped_frames_{0};
+
+    std::mutex reorder_mutex_;
+    std::condition_variable reorder_cv_;
+    std::thread reorder_thread_;// 有序输出超时检查, 析构时停止
+    bool reorder_notified_{false};
+    bool reorder_stop_{false};
+};
+
+}// namespace gddi
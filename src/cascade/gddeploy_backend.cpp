@@ -0,0 +1,29 @@
+#include "gddeploy_backend.h"
+
+namespace gddi {
+
+GddeployBackend::~GddeployBackend() {
+    // 等待设备上的任务及回调完成
+    infer_api_.WaitTaskDone();
+}
+
+bool GddeployBackend::load(const ModelConfig &model) {
+    return infer_api_.Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) == 0;
+}
+
+bool GddeployBackend::infer_sync(const InferTag & /*tag*/, const gddeploy::PackagePtr &in_package,
+                                 gddeploy::PackagePtr &out_package) {
+    return infer_api_.InferSync(in_package, out_package) == 0;
+}
+
+void GddeployBackend::infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                                  InferBackendCallback callback) {
+    infer_api_.InferAsync(
+        in_package, [tag, callback](gddeploy::Status status, gddeploy::PackagePtr data, gddeploy::any /*user_data*/) {
+            callback(tag, status == gddeploy::Status::SUCCESS, data);
+        });
+}
+
+void GddeployBackend::wait_task_done() { infer_api_.WaitTaskDone(); }
+
+}// namespace gddi
@@ -0,0 +1,34 @@
+/**
+ * @file gddeploy_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 默认推理后端 (gddeploy::InferAPI)
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+
+namespace gddi {
+
+class GddeployBackend : public InferBackend {
+public:
+    GddeployBackend() = default;
+    ~GddeployBackend() override;
+
+    bool load(const ModelConfig &model) override;
+    bool infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override;
+    void infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     InferBackendCallback callback) override;
+    void wait_task_done() override;
+
+private:
+    gddeploy::InferAPI infer_api_;
+};
+
+}// namespace gddi
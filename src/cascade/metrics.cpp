@@ -0,0 +1,34 @@
+#include "metrics.h"
+
+namespace gddi {
+
+LatencyRecorder::LatencyRecorder() {
+    for (auto &bucket : buckets_) { bucket.store(0, std::memory_order_relaxed); }
+}
+
+void LatencyRecorder::record(const std::chrono::steady_clock::duration duration) {
+    auto us = (uint64_t)std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0);
+
+    // 桶序号为耗时的二进制位数
+    size_t index = 0;
+    for (auto value = us; value > 0 && index + 1 < kLatencyBuckets; value >>= 1) { index++; }
+
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_us_.fetch_add(us, std::memory_order_relaxed);
+
+    auto max_us = max_us_.load(std::memory_order_relaxed);
+    while (us > max_us && !max_us_.compare_exchange_weak(max_us, us, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram LatencyRecorder::snapshot() const {
+    // 各字段分别读取, 并发写入时快照之间可能有少量偏差
+    LatencyHistogram histogram;
+    histogram.count = count_.load(std::memory_order_relaxed);
+    histogram.total_us = total_us_.load(std::memory_order_relaxed);
+    histogram.max_us = max_us_.load(std::memory_order_relaxed);
+    for (const auto &bucket : buckets_) { histogram.buckets.emplace_back(bucket.load(std::memory_order_relaxed)); }
+    return histogram;
+}
+
+}// namespace gddi
@@ -0,0 +1,74 @@
+/**
+ * @file metrics.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 运行指标采集, 原子计数, 推理线程无锁写入
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "struct_def.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace gddi {
+
+class LatencyRecorder {
+public:
+    LatencyRecorder();
+    ~LatencyRecorder() = default;
+
+    void record(const std::chrono::steady_clock::duration duration);
+
+    LatencyHistogram snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kLatencyBuckets> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> total_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+/**
+ * @brief 作用域计时, 析构时写入
+ */
+class ScopedLatency {
+public:
+    ScopedLatency(LatencyRecorder &recorder) : recorder_(recorder), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() { recorder_.record(std::chrono::steady_clock::now() - start_); }
+
+private:
+    LatencyRecorder &recorder_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+struct CascadeMetrics {
+    CascadeMetrics(const size_t model_number) : models(new LatencyRecorder[model_number]) {}
+
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> failed_frames{0};
+    std::atomic<uint64_t> callbacks{0};
+    std::atomic<uint64_t> crops{0};
+    std::atomic<uint64_t> truncated_crops{0};
+    std::atomic<uint64_t> cached_detections{0};
+    std::atomic<uint64_t> cached_crops{0};
+    std::atomic<uint64_t> motion_skipped{0};
+    std::atomic<uint64_t> zone_filtered{0};
+
+    LatencyRecorder frame;
+    LatencyRecorder convert;
+    LatencyRecorder parse;
+    LatencyRecorder track;
+    LatencyRecorder cover_merge;
+    LatencyRecorder statistic;
+    std::unique_ptr<LatencyRecorder[]> models;// 按模型序号, 数量在构造时确定
+};
+
+}// namespace gddi
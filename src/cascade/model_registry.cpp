@@ -0,0 +1,56 @@
+#include "model_registry.h"
+#include "gddeploy_backend.h"
+
+namespace gddi {
+
+void set_infer_backend(InferBackendCreator creator) { ModelRegistry::instance().set_creator(std::move(creator)); }
+
+InferBackendCreator get_infer_backend() { return ModelRegistry::instance().creator(); }
+
+ModelRegistry &ModelRegistry::instance() {
+    static ModelRegistry registry;
+    return registry;
+}
+
+InferBackendPtr ModelRegistry::acquire(const ModelConfig &model) {
+    // 加载期间持锁, 避免并发加载同一模型
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto key = std::make_pair(model.path, model.license);
+    if (auto backend = models_[key].lock()) { return backend; }
+
+    auto backend = creator_ ? creator_(model) : InferBackendPtr(std::make_shared<GddeployBackend>());
+    if (!backend || !backend->load(model)) {
+        models_.erase(key);
+        return nullptr;
+    }
+
+    // 最后一个句柄释放时先等待在途任务 (含回调) 完成, 再释放模型, 避免回调线程仍在执行时卸载
+    InferBackendPtr handle(backend.get(), [backend](InferBackend *) { backend->wait_task_done(); });
+    models_[key] = handle;
+
+    // 清理已释放的模型
+    for (auto iter = models_.begin(); iter != models_.end();) {
+        if (iter->second.expired()) {
+            iter = models_.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+
+    return handle;
+}
+
+void ModelRegistry::set_creator(InferBackendCreator creator) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    creator_ = std::move(creator);
+    models_.clear();
+}
+
+InferBackendCreator ModelRegistry::creator() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (creator_) { return creator_; }
+    return [](const ModelConfig &) -> InferBackendPtr { return std::make_shared<GddeployBackend>(); };
+}
+
+}// namespace gddi
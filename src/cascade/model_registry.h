@@ -0,0 +1,55 @@
+/**
+ * @file model_registry.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 进程内模型注册表, 相同模型文件只加载一次
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace gddi {
+
+class ModelRegistry {
+public:
+    static ModelRegistry &instance();
+
+    /**
+     * @brief 获取模型, 按 模型路径+授权文件 复用已加载的模型
+     *
+     * 返回引用计数句柄, 最后一个使用者释放时等待在途任务完成后卸载模型
+     *
+     * @param model 模型配置
+     * @return InferBackendPtr 加载失败返回 nullptr
+     */
+    InferBackendPtr acquire(const ModelConfig &model);
+
+    /**
+     * @brief 设置推理后端, 清空复用表 (已加载的模型由使用者继续持有)
+     */
+    void set_creator(InferBackendCreator creator);
+
+    /**
+     * @brief 当前推理后端, 未设置时为默认后端
+     */
+    InferBackendCreator creator();
+
+private:
+    ModelRegistry() = default;
+
+    std::mutex mutex_;
+    InferBackendCreator creator_;
+    std::map<std::pair<std::string, std::string>, std::weak_ptr<InferBackend>> models_;
+};
+
+}// namespace gddi
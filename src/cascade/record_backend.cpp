@@ -0,0 +1,320 @@
+#include "record_backend.h"
+#include "detection_record.h"
+#include "model_registry.h"
+#include "spdlog/spdlog.h"
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace gddi {
+
+static constexpr char kRecordMagic[4] = {'G', 'D', 'R', 'C'};
+static constexpr uint32_t kRecordVersion = 1;
+static constexpr size_t kRecordBufferSize = 4 << 20;// 写缓冲, 避免每次推理都产生系统调用
+
+template<typename T>
+static void write_value(std::ostream &stream, const T &value) {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool read_value(std::istream &stream, T &value) {
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+static bool write_string(std::ostream &stream, const std::string &value) {
+    // 长度按 uint16_t 存储, 超长字符串无法回读
+    if (value.size() > std::numeric_limits<uint16_t>::max()) { return false; }
+
+    write_value<uint16_t>(stream, value.size());
+    stream.write(value.data(), value.size());
+    return true;
+}
+
+static bool read_string(std::istream &stream, std::string &value) {
+    uint16_t length = 0;
+    if (!read_value(stream, length)) { return false; }
+    value.resize(length);
+    return static_cast<bool>(stream.read(&value[0], length));
+}
+
+bool DetectionRecorder::open(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.resize(kRecordBufferSize);
+    file_.rdbuf()->pubsetbuf(buffer_.data(), buffer_.size());
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) { return false; }
+
+    file_.write(kRecordMagic, sizeof(kRecordMagic));
+    write_value(file_, kRecordVersion);
+    return true;
+}
+
+void DetectionRecorder::write(const std::string &model_path, const InferTag &tag,
+                              const gddeploy::PackagePtr &package) {
+    // 在锁外序列化, 持锁只追加到文件缓冲
+    std::ostringstream record;
+    bool valid = write_string(record, model_path);
+    write_value<int32_t>(record, tag.stream_id);
+    write_value<int64_t>(record, tag.image_id);
+    write_value<uint32_t>(record, package->data.size());
+
+    for (const auto &data : package->data) {
+        std::vector<gddeploy::DetectObject> objects;
+        if (data->HasMetaValue()) {
+            auto infer_result = data->GetMetaData<gddeploy::InferResult>();
+            for (const auto &item : infer_result.detect_result.detect_imgs) {
+                objects.insert(objects.end(), item.detect_objs.begin(), item.detect_objs.end());
+            }
+        }
+
+        write_value<uint32_t>(record, objects.size());
+        for (const auto &obj : objects) {
+            write_value<int32_t>(record, obj.class_id);
+            write_value<float>(record, obj.score);
+            write_value<float>(record, obj.bbox.x);
+            write_value<float>(record, obj.bbox.y);
+            write_value<float>(record, obj.bbox.w);
+            write_value<float>(record, obj.bbox.h);
+            valid = write_string(record, obj.label) && valid;
+        }
+    }
+
+    if (!valid) {
+        spdlog::error("Skip detection record with model path or label longer than {} bytes: stream {} image {}",
+                      std::numeric_limits<uint16_t>::max(), tag.stream_id, tag.image_id);
+        return;
+    }
+
+    auto data = record.str();
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.write(data.data(), data.size());
+}
+
+void DetectionRecorder::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.flush();
+}
+
+bool DetectionRecording::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) { return false; }
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kRecordMagic, sizeof(magic)) != 0
+        || !read_value(file, version) || version != kRecordVersion) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+
+    std::string model_path;
+    while (read_string(file, model_path)) {
+        int32_t stream_id = 0;
+        int64_t image_id = 0;
+        uint32_t item_number = 0;
+        if (!read_value(file, stream_id) || !read_value(file, image_id) || !read_value(file, item_number)) {
+            return false;
+        }
+
+        RecordedItems items(item_number);
+        for (auto &objects : items) {
+            uint32_t object_number = 0;
+            if (!read_value(file, object_number)) { return false; }
+
+            objects.resize(object_number);
+            for (auto &obj : objects) {
+                if (!read_value(file, obj.class_id) || !read_value(file, obj.score) || !read_value(file, obj.bbox.x)
+                    || !read_value(file, obj.bbox.y) || !read_value(file, obj.bbox.w) || !read_value(file, obj.bbox.h)
+                    || !read_string(file, obj.label)) {
+                    return false;
+                }
+            }
+        }
+
+        records_[std::make_tuple(model_path, stream_id, image_id)].emplace_back(std::move(items));
+    }
+
+    return true;
+}
+
+bool DetectionRecording::next(const std::string &model_path, const InferTag &tag, RecordedItems &items) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = records_.find(std::make_tuple(model_path, tag.stream_id, tag.image_id));
+    if (iter == records_.end() || iter->second.empty()) { return false; }
+
+    items = std::move(iter->second.front());
+    iter->second.pop_front();
+    return true;
+}
+
+bool RecordInferBackend::load(const ModelConfig &model) {
+    model_path_ = model.path;
+    return backend_->load(model);
+}
+
+bool RecordInferBackend::infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                                    gddeploy::PackagePtr &out_package) {
+    auto success = backend_->infer_sync(tag, in_package, out_package);
+    if (success) { recorder_->write(model_path_, tag, out_package); }
+    return success;
+}
+
+void RecordInferBackend::infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                                     InferBackendCallback callback) {
+    backend_->infer_async(
+        tag, in_package,
+        [this, callback](const InferTag &tag, bool success, const gddeploy::PackagePtr &out_package) {
+            if (success) { recorder_->write(model_path_, tag, out_package); }
+            callback(tag, success, out_package);
+        });
+}
+
+ReplayInferBackend::ReplayInferBackend(const std::shared_ptr<DetectionRecording> &recording, const uint32_t latency)
+    : recording_(recording), latency_(latency) {
+    worker_ = std::thread([this]() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(task_mutex_);
+            task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) { break; }
+
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            running_task_ = true;
+            lock.unlock();
+
+            const auto &tag = std::get<0>(task);
+            auto out_package = gddeploy::Package::Create(std::get<1>(task)->data.size());
+            auto success = infer_sync(tag, std::get<1>(task), out_package);
+            std::get<2>(task)(tag, success, out_package);
+
+            lock.lock();
+            running_task_ = false;
+            task_cv_.notify_all();
+        }
+    });
+}
+
+ReplayInferBackend::~ReplayInferBackend() {
+    {
+        std::lock_guard<std::mutex> lock(task_mutex_);
+        stop_ = true;
+        task_cv_.notify_all();
+    }
+    worker_.join();
+}
+
+bool ReplayInferBackend::load(const ModelConfig &model) {
+    model_path_ = model.path;
+    return true;
+}
+
+bool ReplayInferBackend::infer_sync(const InferTag &tag, const gddeploy::PackagePtr & /*in_package*/,
+                                    gddeploy::PackagePtr &out_package) {
+    if (latency_ > 0) { std::this_thread::sleep_for(std::chrono::microseconds(latency_)); }
+
+    RecordedItems items;
+    if (!recording_->next(model_path_, tag, items)) {
+        spdlog::warn("No recorded result: {} - stream {} image {}", model_path_, tag.stream_id, tag.image_id);
+    }
+
+    for (size_t i = 0; i < out_package->data.size(); i++) {
+        gddeploy::DetectImg detect_img;
+        detect_img.img_id = i;
+        if (i < items.size()) { detect_img.detect_objs = std::move(items[i]); }
+
+        gddeploy::InferResult infer_result;
+        infer_result.result_type.emplace_back(gddeploy::GDD_RESULT_TYPE_DETECT);
+        infer_result.detect_result.batch_size = 1;
+        infer_result.detect_result.detect_imgs.emplace_back(std::move(detect_img));
+        out_package->data[i]->SetMetaData(std::move(infer_result));
+    }
+
+    return true;
+}
+
+void ReplayInferBackend::infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                                     InferBackendCallback callback) {
+    std::lock_guard<std::mutex> lock(task_mutex_);
+    tasks_.emplace_back(tag, in_package, std::move(callback));
+    task_cv_.notify_all();
+}
+
+void ReplayInferBackend::wait_task_done() {
+    std::unique_lock<std::mutex> lock(task_mutex_);
+    task_cv_.wait(lock, [this] { return tasks_.empty() && !running_task_; });
+}
+
+// 录制/回放前的推理后端, 停止时恢复
+static std::mutex g_record_mutex;
+static InferBackendCreator g_saved_creator;
+static bool g_recording{false};
+static bool g_replaying{false};
+static std::shared_ptr<DetectionRecorder> g_recorder;
+
+bool start_detection_record(const std::string &path) {
+    auto recorder = std::make_shared<DetectionRecorder>();
+    if (!recorder->open(path)) {
+        spdlog::error("Failed to create detection record: {}", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_record_mutex);
+    auto creator = ModelRegistry::instance().creator();
+    if (!g_recording && !g_replaying) { g_saved_creator = creator; }
+    if (g_recorder) { g_recorder->flush(); }
+    g_recording = true;
+    g_recorder = recorder;
+
+    ModelRegistry::instance().set_creator([creator, recorder](const ModelConfig &model) -> InferBackendPtr {
+        auto backend = creator(model);
+        if (!backend) { return nullptr; }
+        return std::make_shared<RecordInferBackend>(backend, recorder);
+    });
+
+    return true;
+}
+
+void stop_detection_record() {
+    std::lock_guard<std::mutex> lock(g_record_mutex);
+    if (!g_recording) { return; }
+
+    g_recording = false;
+    ModelRegistry::instance().set_creator(g_saved_creator);
+
+    // 仍在使用的模型继续持有录制器, 其后的记录在录制器析构时写入
+    g_recorder->flush();
+    g_recorder.reset();
+}
+
+bool start_detection_replay(const std::string &path, const uint32_t latency) {
+    auto recording = std::make_shared<DetectionRecording>();
+    if (!recording->load(path)) {
+        spdlog::error("Failed to load detection record: {}", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_record_mutex);
+    if (!g_recording && !g_replaying) { g_saved_creator = ModelRegistry::instance().creator(); }
+    g_replaying = true;
+
+    ModelRegistry::instance().set_creator([recording, latency](const ModelConfig &) -> InferBackendPtr {
+        return std::make_shared<ReplayInferBackend>(recording, latency);
+    });
+
+    return true;
+}
+
+void stop_detection_replay() {
+    std::lock_guard<std::mutex> lock(g_record_mutex);
+    if (!g_replaying) { return; }
+
+    g_replaying = false;
+    ModelRegistry::instance().set_creator(g_saved_creator);
+}
+
+}// namespace gddi
@@ -0,0 +1,113 @@
+/**
+ * @file record_backend.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 检测结果录制/回放后端
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * 录制文件格式 (主机字节序):
+ *   文件头: "GDRC" + uint32 版本
+ *   记录:   uint16 模型路径长度 + 模型路径, int32 视频流ID, int64 帧ID, uint32 输入数
+ *           每个输入: uint32 目标数
+ *           每个目标: int32 class_id, float score, float x/y/w/h, uint16 标签长度 + 标签
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include "infer_backend.h"
+#include <condition_variable>
+#include <core/result_def.h>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace gddi {
+
+using RecordedItems = std::vector<std::vector<gddeploy::DetectObject>>;// 每个输入的检测目标
+
+class DetectionRecorder {
+public:
+    /**
+     * @brief 打开录制文件, 写入经缓冲, 在 flush 或析构时落盘
+     */
+    bool open(const std::string &path);
+
+    void write(const std::string &model_path, const InferTag &tag, const gddeploy::PackagePtr &package);
+    void flush();
+
+private:
+    std::mutex mutex_;
+    std::vector<char> buffer_;
+    std::ofstream file_;
+};
+
+class DetectionRecording {
+public:
+    bool load(const std::string &path);
+
+    /**
+     * @brief 取出下一条记录, 同一帧多次推理按录制顺序返回
+     */
+    bool next(const std::string &model_path, const InferTag &tag, RecordedItems &items);
+
+private:
+    std::mutex mutex_;
+    std::map<std::tuple<std::string, int, int64_t>, std::deque<RecordedItems>> records_;
+};
+
+class RecordInferBackend : public InferBackend {
+public:
+    RecordInferBackend(const InferBackendPtr &backend, const std::shared_ptr<DetectionRecorder> &recorder)
+        : backend_(backend), recorder_(recorder) {}
+
+    bool load(const ModelConfig &model) override;
+    bool infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override;
+    void infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     InferBackendCallback callback) override;
+    void wait_task_done() override { backend_->wait_task_done(); }
+
+private:
+    InferBackendPtr backend_;
+    std::shared_ptr<DetectionRecorder> recorder_;
+    std::string model_path_;
+};
+
+class ReplayInferBackend : public InferBackend {
+public:
+    ReplayInferBackend(const std::shared_ptr<DetectionRecording> &recording, const uint32_t latency);
+    ~ReplayInferBackend() override;
+
+    bool load(const ModelConfig &model) override;
+    bool infer_sync(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                    gddeploy::PackagePtr &out_package) override;
+
+    /**
+     * @brief 与真实后端一致, 在回放线程按提交顺序执行 (含模拟耗时) 后回调, 不在调用线程直接回调
+     */
+    void infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                     InferBackendCallback callback) override;
+    void wait_task_done() override;
+
+private:
+    std::shared_ptr<DetectionRecording> recording_;
+    uint32_t latency_;
+    std::string model_path_;
+
+    std::mutex task_mutex_;
+    std::condition_variable task_cv_;
+    std::deque<std::tuple<InferTag, gddeploy::PackagePtr, InferBackendCallback>> tasks_;
+    bool running_task_{false};
+    bool stop_{false};
+    std::thread worker_;
+};
+
+}// namespace gddi
@@ -0,0 +1,77 @@
+#include "reorder_buffer.h"
+
+namespace gddi {
+
+uint64_t ReorderBuffer::push(const int64_t image_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto sequence = ++sequence_;
+    pending_frames_[std::make_pair(image_id, sequence)].push_time = std::chrono::steady_clock::now();
+
+    // 新帧提交时同时检查队首超时
+    release(lock);
+
+    return sequence;
+}
+
+void ReorderBuffer::set_timeout(const std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timeout_ = timeout;
+}
+
+bool ReorderBuffer::complete(const int64_t image_id, const uint64_t sequence, std::function<void()> deliver) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = pending_frames_.find(std::make_pair(image_id, sequence));
+    if (iter == pending_frames_.end()) { return false; }
+
+    iter->second.finished = true;
+    iter->second.deliver = std::move(deliver);
+    release(lock);
+
+    return true;
+}
+
+void ReorderBuffer::skip(const int64_t image_id, const uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_frames_.erase(std::make_pair(image_id, sequence));
+    release(lock);
+}
+
+bool ReorderBuffer::head_deadline(std::chrono::steady_clock::time_point &deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_frames_.empty()) { return false; }
+
+    deadline = pending_frames_.begin()->second.push_time + timeout_;
+    return true;
+}
+
+void ReorderBuffer::expire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    release(lock);
+}
+
+void ReorderBuffer::release(std::unique_lock<std::mutex> &lock) {
+    auto now = std::chrono::steady_clock::now();
+    while (!pending_frames_.empty()) {
+        auto iter = pending_frames_.begin();
+        if (!iter->second.finished && now - iter->second.push_time < timeout_) { break; }
+
+        // 超时未完成的帧直接跳过, 之后返回的结果由 complete 丢弃
+        if (iter->second.finished) { ready_frames_.emplace_back(std::move(iter->second.deliver)); }
+        pending_frames_.erase(iter);
+    }
+
+    if (delivering_) { return; }
+
+    delivering_ = true;
+    while (!ready_frames_.empty()) {
+        auto deliver = std::move(ready_frames_.front());
+        ready_frames_.pop_front();
+
+        lock.unlock();
+        deliver();
+        lock.lock();
+    }
+    delivering_ = false;
+}
+
+}// namespace gddi
@@ -0,0 +1,87 @@
+/**
+ * @file reorder_buffer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 异步结果重排, 按帧ID顺序输出
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace gddi {
+
+class ReorderBuffer {
+public:
+    /**
+     * @param timeout 队首帧等待超时, 超时后跳过该帧
+     */
+    ReorderBuffer(const std::chrono::milliseconds timeout) : timeout_(timeout) {}
+    ~ReorderBuffer() = default;
+
+    /**
+     * @brief 提交帧时登记
+     *
+     * @param image_id 帧ID
+     * @return uint64_t 序号, complete/skip 时传入
+     */
+    uint64_t push(const int64_t image_id);
+
+    void set_timeout(const std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 帧完成, 之前的帧全部完成(或跳过)后按帧ID顺序调用 deliver
+     *
+     * @return false 该帧已超时被跳过, 结果丢弃
+     */
+    bool complete(const int64_t image_id, const uint64_t sequence, std::function<void()> deliver);
+
+    /**
+     * @brief 跳过帧 (丢帧)
+     */
+    void skip(const int64_t image_id, const uint64_t sequence);
+
+    /**
+     * @brief 队首未完成帧的超时时刻
+     *
+     * @return false 无等待中的帧
+     */
+    bool head_deadline(std::chrono::steady_clock::time_point &deadline);
+
+    /**
+     * @brief 检查队首超时并释放其后已完成的帧, 供定时线程在没有新的 push/complete/skip 时调用
+     */
+    void expire();
+
+private:
+    struct PendingFrame {
+        std::chrono::steady_clock::time_point push_time;
+        bool finished{false};
+        std::function<void()> deliver;
+    };
+
+    /**
+     * @brief 释放队首已完成/超时的帧并依次回调, 同一时刻只有一个线程回调以保证顺序
+     */
+    void release(std::unique_lock<std::mutex> &lock);
+
+    std::chrono::milliseconds timeout_;
+
+    std::mutex mutex_;
+    uint64_t sequence_{0};
+    std::map<std::pair<int64_t, uint64_t>, PendingFrame> pending_frames_;// 帧ID+序号 (帧ID重复时按提交顺序)
+    std::deque<std::function<void()>> ready_frames_;
+    bool delivering_{false};
+};
+
+}// namespace gddi
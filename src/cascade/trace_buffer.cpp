@@ -0,0 +1,147 @@
+#include "trace_buffer.h"
+#include "pipeline_trace.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <fstream>
+#include <unistd.h>
+
+namespace gddi {
+
+// JSON 字符串转义 (阶段/模型名称来自配置, 可能含引号等字符)
+static std::string json_escape(const char *value) {
+    std::string escaped;
+    for (auto *p = value; *p != '\0'; p++) {
+        auto c = static_cast<unsigned char>(*p);
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    escaped += fmt::format("\\u{:04x}", c);
+                } else {
+                    escaped += static_cast<char>(c);
+                }
+        }
+    }
+    return escaped;
+}
+
+TraceBuffer &TraceBuffer::instance() {
+    static TraceBuffer buffer;
+    return buffer;
+}
+
+void TraceBuffer::start(const size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_.store(false, std::memory_order_relaxed);
+
+    // 容量不变时复用缓冲区
+    if (rings_.empty() || rings_.back()->capacity != std::max<size_t>(capacity, 1)) {
+        rings_.emplace_back(std::make_unique<Ring>(std::max<size_t>(capacity, 1)));
+    }
+
+    auto ring = rings_.back().get();
+    for (size_t i = 0; i < ring->capacity; i++) { ring->slots[i].sequence.store(0, std::memory_order_relaxed); }
+    ring->next.store(0, std::memory_order_relaxed);
+
+    start_time_ = std::chrono::steady_clock::now();
+    ring_.store(ring, std::memory_order_release);
+
+    enabled_.store(true, std::memory_order_release);
+}
+
+bool TraceBuffer::stop(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_.store(false, std::memory_order_relaxed);
+
+    auto ring = ring_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!ring) { return false; }
+
+    // 读取时写入线程可能仍在写入, 前后代数一致且为偶数才视为有效
+    std::vector<TraceEvent> events;
+    for (size_t i = 0; i < ring->capacity; i++) {
+        auto &slot = ring->slots[i];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == 0 || (sequence & 1) != 0) { continue; }
+
+        auto event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) { events.emplace_back(event); }
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        spdlog::error("Failed to create pipeline trace: {}", path);
+        return false;
+    }
+
+    std::sort(events.begin(), events.end(),
+              [](const TraceEvent &item1, const TraceEvent &item2) { return item1.begin < item2.begin; });
+
+    auto to_us = [this](const std::chrono::steady_clock::time_point &time) {
+        return std::chrono::duration<double, std::micro>(time - start_time_).count();
+    };
+
+    const auto pid = getpid();
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const auto &event = events[i];
+        auto name = event.detail ? event.detail : event.stage;
+        auto head = fmt::format("{{\"name\":\"{}\",\"cat\":\"{}\",\"pid\":{},\"tid\":{},", json_escape(name),
+                                json_escape(event.stage), pid, event.thread_id);
+        auto args = fmt::format("\"args\":{{\"stream_id\":{},\"image_id\":{}}}}}", event.stream_id, event.image_id);
+
+        if (i > 0) { file << ","; }
+        if (event.async) {
+            // 异步事件按 id 配对, 起止可能不在同一线程
+            file << head << "\"ph\":\"b\",\"id\":" << i << ",\"ts\":" << to_us(event.begin) << "," << args;
+            file << "," << head << "\"ph\":\"e\",\"id\":" << i << ",\"ts\":" << to_us(event.end) << "," << args;
+        } else {
+            file << head << "\"ph\":\"X\",\"ts\":" << to_us(event.begin)
+                 << ",\"dur\":" << std::chrono::duration<double, std::micro>(event.end - event.begin).count() << ","
+                 << args;
+        }
+    }
+    file << "]}\n";
+
+    return true;
+}
+
+void TraceBuffer::record(const TraceEvent &event) {
+    auto ring = ring_.load(std::memory_order_acquire);
+    if (!ring) { return; }
+
+    auto index = ring->next.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = ring->slots[index % ring->capacity];
+
+    // 写入前将代数置为奇数占用槽位, 绕回一圈的另一写入者仍在写入时放弃本条记录, 避免交错写出半条事件
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0
+        || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+const char *TraceBuffer::intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.insert(name).first->c_str();
+}
+
+uint32_t TraceBuffer::thread_id() {
+    static std::atomic<uint32_t> next_id{1};
+    thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void start_pipeline_trace(const size_t capacity) { TraceBuffer::instance().start(capacity); }
+
+bool stop_pipeline_trace(const std::string &path) { return TraceBuffer::instance().stop(path); }
+
+}// namespace gddi
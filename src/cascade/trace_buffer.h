@@ -0,0 +1,107 @@
+/**
+ * @file trace_buffer.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 阶段追踪环形缓冲区, 写入无锁, 写满覆盖最早记录
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gddi {
+
+struct TraceEvent {
+    const char *stage; // 阶段, 导出为 cat
+    const char *detail;// 模型名称等, 导出为 name, 为空时使用 stage
+    int stream_id;
+    int64_t image_id;
+    uint32_t thread_id;
+    bool async;// 跨线程完成 (异步推理/整帧), 导出为异步事件
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+};
+
+class TraceBuffer {
+public:
+    static TraceBuffer &instance();
+
+    static bool enabled() { return instance().enabled_.load(std::memory_order_relaxed); }
+
+    void start(const size_t capacity);
+    bool stop(const std::string &path);
+
+    void record(const TraceEvent &event);
+
+    /**
+     * @brief 名称常驻内存, 记录中只保存指针
+     */
+    const char *intern(const std::string &name);
+
+    /**
+     * @brief 当前线程编号, 按首次记录顺序分配
+     */
+    static uint32_t thread_id();
+
+private:
+    TraceBuffer() = default;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};// 写入代数 (seqlock), 奇数为写入中, 0 为空
+        TraceEvent event;
+    };
+
+    struct Ring {
+        Ring(const size_t capacity) : capacity(capacity), slots(new Slot[capacity]) {}
+
+        const size_t capacity;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> next{0};
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<Ring *> ring_{nullptr};
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;// 写入线程可能仍持有旧缓冲区, 不释放
+    std::set<std::string> names_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+/**
+ * @brief 作用域追踪, 析构时写入
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char *stage, const int stream_id, const int64_t image_id, const char *detail = nullptr)
+        : enabled_(TraceBuffer::enabled()) {
+        if (enabled_) {
+            event_ = TraceEvent{stage, detail, stream_id, image_id, 0, false, std::chrono::steady_clock::now(), {}};
+        }
+    }
+
+    ~TraceSpan() {
+        if (enabled_) {
+            event_.thread_id = TraceBuffer::thread_id();
+            event_.end = std::chrono::steady_clock::now();
+            TraceBuffer::instance().record(event_);
+        }
+    }
+
+private:
+    bool enabled_;
+    TraceEvent event_;
+};
+
+}// namespace gddi
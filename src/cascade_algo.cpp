@@ -0,0 +1,22 @@
+#include "cascade_algo.h"
+#include "cascade/cascade.h"
+
+namespace gddi {
+
+CascadeAlgo::CascadeAlgo() = default;
+
+CascadeAlgo::~CascadeAlgo() = default;
+
+void CascadeAlgo::release_stream(const int stream_id) { cascade_->release_stream(stream_id); }
+
+void CascadeAlgo::set_zone(const int stream_id, const ZoneConfig &config) { cascade_->set_zone(stream_id, config); }
+
+AlgoMetrics CascadeAlgo::get_metrics() const { return cascade_->get_metrics(); }
+
+void CascadeAlgo::set_flow_control(const FlowControlConfig &config) { cascade_->set_flow_control(config); }
+
+uint64_t CascadeAlgo::dropped_frames() const { return cascade_->dropped_frames(); }
+
+Cascade *CascadeAlgo::cascade() const { return cascade_.get(); }
+
+}// namespace gddi
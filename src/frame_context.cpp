@@ -0,0 +1,55 @@
+#include "frame_context.h"
+#include "surface_utils.h"
+
+namespace gddi {
+
+gddeploy::BufSurfWrapperPtr FrameContext::surface() {
+    std::lock_guard<std::mutex> lock(surface_mutex_);
+    if (!surface_) { convertMat2BufSurface(image_, surface_); }
+    return surface_;
+}
+
+gddeploy::BufSurfWrapperPtr FrameContext::crop_surface(const cv::Rect &rect) {
+    std::lock_guard<std::mutex> lock(surface_mutex_);
+    auto &crop_surface = crop_surfaces_[std::make_tuple(rect.x, rect.y, rect.width, rect.height)];
+    if (!crop_surface) { convert_crop_surface(image_, rect, crop_surface); }
+    return crop_surface;
+}
+
+void FrameContext::share_infer(const InferKey &key, const std::function<void(const InferDone &)> &infer,
+                               const InferDone &done) {
+    std::unique_lock<std::mutex> lock(infer_mutex_);
+    auto iter = shared_infers_.find(key);
+    if (iter != shared_infers_.end()) {
+        if (iter->second.finished) {
+            auto success = iter->second.success;
+            auto package = iter->second.package;
+            lock.unlock();
+            return done(success, package);
+        }
+
+        // 推理中, 等待结果
+        iter->second.waiters.emplace_back(done);
+        return;
+    }
+
+    shared_infers_[key].waiters.emplace_back(done);
+    lock.unlock();
+
+    // 等待者持有本帧上下文, 回调前不会释放
+    infer([this, key](bool success, const gddeploy::PackagePtr &package) {
+        std::vector<InferDone> waiters;
+        {
+            std::lock_guard<std::mutex> lock(infer_mutex_);
+            auto &shared_infer = shared_infers_[key];
+            shared_infer.finished = true;
+            shared_infer.success = success;
+            shared_infer.package = package;
+            waiters.swap(shared_infer.waiters);
+        }
+
+        for (const auto &waiter : waiters) { waiter(success, package); }
+    });
+}
+
+}// namespace gddi
@@ -0,0 +1,81 @@
+/**
+ * @file frame_context.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief 单帧推理上下文, 级联各阶段共享同一份 surface 及整帧推理结果
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <api/infer_api.h>
+#include <common/type_convert.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/core/mat.hpp>
+#include <tuple>
+#include <vector>
+
+namespace gddi {
+
+using InferDone = std::function<void(bool, const gddeploy::PackagePtr &)>;
+using InferKey = std::tuple<const void *, float, float>;// 模型, 置信度阈值, NMS阈值 (未下发为 -1)
+
+class FrameContext {
+public:
+    FrameContext(const int64_t image_id, const cv::Mat &image) : image_id_(image_id), image_(image) {}
+    ~FrameContext() = default;
+
+    int64_t image_id() const { return image_id_; }
+    const cv::Mat &image() const { return image_; }
+
+    /**
+     * @brief 整帧 surface, 首次访问时转换, 之后各阶段复用
+     */
+    gddeploy::BufSurfWrapperPtr surface();
+
+    /**
+     * @brief 裁剪区域 surface, 相同区域只转换一次
+     *
+     * @param rect 裁剪区域, 需在图像范围内
+     */
+    gddeploy::BufSurfWrapperPtr crop_surface(const cv::Rect &rect);
+
+    /**
+     * @brief 整帧推理结果复用, 多个算法共享同一帧时相同模型+参数只推理一次
+     *
+     * 首个调用者执行 infer, 推理未完成时后续调用者挂起, 结果返回后依次回调
+     *
+     * @param key   模型+参数
+     * @param infer 推理函数, 完成后调用传入的 InferDone
+     * @param done  结果回调
+     */
+    void share_infer(const InferKey &key, const std::function<void(const InferDone &)> &infer, const InferDone &done);
+
+private:
+    struct SharedInfer {
+        bool finished{false};
+        bool success{false};
+        gddeploy::PackagePtr package;
+        std::vector<InferDone> waiters;
+    };
+
+    int64_t image_id_;
+    cv::Mat image_;
+
+    std::mutex surface_mutex_;
+    gddeploy::BufSurfWrapperPtr surface_;
+    std::map<std::tuple<int, int, int, int>, gddeploy::BufSurfWrapperPtr> crop_surfaces_;
+
+    std::mutex infer_mutex_;
+    std::map<InferKey, SharedInfer> shared_infers_;
+};
+
+using FrameContextPtr = std::shared_ptr<FrameContext>;
+
+}// namespace gddi
@@ -1,143 +1,40 @@
 #include "helmet_algo.h"
-#include "bytetrack/BYTETracker.h"
-#include "sequence_statistic.h"
-//#include "spdlog/spdlog.h"
-#include "utils.h"
-#include <api/global_config.h>
-#include <bmcv_api_ext.h>
-#include <common/type_convert.h>
-#include <mutex>
+#include "cascade/cascade.h"
 
 namespace gddi {
 
-class HelmetAlgo::HelmetAlgoPrivate {
-public:
-    std::unique_ptr<BYTETracker> tracker;
-    std::unique_ptr<SequenceStatistic> sequence_statistic;
-
-    std::mutex model_mutex;
-    std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
-};
-
 HelmetAlgo::HelmetAlgo(const HelmetAlgoConfig &config) : config_(config) {
-    gddeploy::gddeploy_init("");
-    private_ = std::make_unique<HelmetAlgoPrivate>();
-
-    private_->tracker = std::make_unique<BYTETracker>(0.3, 0.6, 0.8, 30);
-    private_->sequence_statistic =
-        std::make_unique<SequenceStatistic>(config_.statistics_interval, config_.statistics_threshold);
+    // 行人检测 -> 裁剪安全帽检测 (输出未戴安全帽目标)
+    cascade_ = std::make_unique<Cascade>(
+        "HelmetAlgo",
+        std::vector<CascadeStage>{
+            CascadeStage::detect(0, ObjectFilter::all(true), {}, true),
+            CascadeStage::zone(),
+            CascadeStage::finish_if_empty(),
+            CascadeStage::top_k(1),
+            CascadeStage::crop_detect(1, CropMerge::kOffset, ObjectFilter::except({"helmet"}, true)),
+            CascadeStage::filter_if([threshold = config_.cover_threshold](const AlgoObject &object) {
+                return object.score > threshold;
+            }),
+        },
+        config_.statistics_interval, config_.statistics_threshold);
+    cascade_->set_motion_gate(config_.motion_gate);
+    cascade_->set_zone(config_.zone);
 }
 
-HelmetAlgo::~HelmetAlgo() {
-    for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
-}
+HelmetAlgo::~HelmetAlgo() = default;
 
 bool HelmetAlgo::load_models(const std::vector<ModelConfig> &models) {
-    std::lock_guard<std::mutex> lock(private_->model_mutex);
-    private_->model_impls.clear();
-
-    private_->model_configs = models;
-    for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
-        if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
-            //spdlog::error("Failed to load model: {} - {}", model.name, model.path);
-            return false;
-        }
-        private_->model_impls.emplace_back(std::move(algo_impl));
-    }
-
-    return true;
+    return cascade_->load_models(models);
 }
 
-
 bool HelmetAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &statistic_objects) {
-    gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
-
-    auto in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-
-    auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
-
-    std::vector<AlgoObject> infer_objects,infer_objects2;
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        infer_objects = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[0].threshold);
-    }
-    // 二阶段检测
-    if (!infer_objects.empty()) {
-        // 裁剪目标 & 排序
-        std::sort(infer_objects.begin(), infer_objects.end(), [](const AlgoObject &item1, const AlgoObject &item2) {
-            return item1.score > item2.score
-                && item1.rect.width * item1.rect.height > item2.rect.width * item2.rect.height;
-        });
-
-        // 裁剪目标数
-        if (infer_objects.size() > private_->model_configs[1].max_crop_number) {
-            infer_objects.resize(private_->model_configs[1].max_crop_number);
-        }
-
-        std::vector<cv::Rect> crop_rects;
-        std::vector<cv::Mat> crop_images;
-        for (const auto &item : infer_objects) {
-            auto rect =
-                scale_crop_rect(image.cols, image.rows, item.rect, private_->model_configs[1].crop_scale_factor);
-            crop_images.emplace_back (image(rect).clone());
-            crop_rects.emplace_back(rect);
-        }
-
-        for (int i=0;i<crop_images.size();++i) {
-
-            auto in_package = gddeploy::Package::Create(1);
-            auto out_package = gddeploy::Package::Create(1);
-
-            gddeploy::BufSurfWrapperPtr surface_;
-            convertMat2BufSurface(const_cast<cv::Mat &>(crop_images[i]), surface_);
-            in_package->data[0]->Set(surface_);
-
-            private_->model_impls[1]->InferSync(in_package, out_package);
-            if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                infer_objects2 = parse_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[1].threshold);
-            }
-            for(auto &val : infer_objects2 )
-            {
-                if(val.score >config_.cover_threshold && val.label !="helmet" )
-                {
-                    val.rect.x+=infer_objects[i].rect.x;
-                    val.rect.y+=infer_objects[i].rect.y;
-                    statistic_objects.push_back(val);
-                }
-
-            }
-        }
-    }
-
-    return true;
+    return sync_infer(kDefaultStreamId, image_id, image, statistic_objects);
 }
 
-std::vector<AlgoObject> HelmetAlgo::parse_infer_result(const gddeploy::InferResult &infer_result,
-                                                      const float threshold) {
-    std::vector<AlgoObject> objects;
-
-    for (auto result_type : infer_result.result_type) {
-        if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
-            for (const auto &item : infer_result.detect_result.detect_imgs) {
-                int index = 1;
-                for (auto &obj : item.detect_objs) {
-                    if (obj.score < threshold) { continue; }
-
-                    objects.emplace_back(
-                        AlgoObject{index++, obj.class_id, obj.label, obj.score,
-                                   cv::Rect{(int)obj.bbox.x, (int)obj.bbox.y, (int)obj.bbox.w, (int)obj.bbox.h}});
-                }
-            }
-        }
-    }
-
-    return objects;
+bool HelmetAlgo::sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                            std::vector<AlgoObject> &statistic_objects) {
+    return cascade_->sync_infer(stream_id, image_id, image, statistic_objects);
 }
 
-}// namespace gddi
\ No newline at end of file
+}// namespace gddi
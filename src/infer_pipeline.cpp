@@ -0,0 +1,101 @@
+#include "infer_pipeline.h"
+#include "cascade/cascade.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace gddi {
+
+// 单帧结果, 完成前占位保证输出顺序
+struct PipelineSlot {
+    PipelineResult result;
+    bool finished{false};
+};
+
+class InferPipeline::InferPipelinePrivate {
+public:
+    Cascade *cascade;
+    size_t depth;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<PipelineSlot>> slots;// 提交顺序, 不超过 depth
+    size_t inflight{0};                             // 已提交未完成
+    uint64_t dropped{0};                            // 未取出被丢弃的结果数
+};
+
+InferPipeline::InferPipeline(Cascade *cascade, const size_t depth) {
+    private_ = std::make_unique<InferPipelinePrivate>();
+    private_->cascade = cascade;
+    private_->depth = std::max<size_t>(depth, 1);
+}
+
+InferPipeline::~InferPipeline() {
+    // 回调持有 private_, 等待在途帧完成
+    std::unique_lock<std::mutex> lock(private_->mutex);
+    private_->cv.wait(lock, [this] { return private_->inflight == 0; });
+}
+
+void InferPipeline::submit(const int64_t image_id, const cv::Mat &image) {
+    submit(kDefaultStreamId, image_id, image);
+}
+
+void InferPipeline::submit(const int stream_id, const int64_t image_id, const cv::Mat &image) {
+    auto slot = std::make_shared<PipelineSlot>();
+    slot->result = PipelineResult{stream_id, image_id, image, {}, false};
+
+    {
+        std::unique_lock<std::mutex> lock(private_->mutex);
+        private_->cv.wait(lock, [this] {
+            return private_->inflight < private_->depth
+                && (private_->slots.size() < private_->depth || private_->slots.front()->finished);
+        });
+
+        // 未取出的结果占满时丢弃最早的结果
+        if (private_->slots.size() >= private_->depth) {
+            private_->slots.pop_front();
+            private_->dropped++;
+        }
+
+        private_->inflight++;
+        private_->slots.emplace_back(slot);
+    }
+
+    auto *impl = private_.get();
+    impl->cascade->run_async(stream_id, std::make_shared<FrameContext>(image_id, image),
+                             [impl, slot](const bool success, const std::vector<AlgoObject> &objects) {
+                                 std::lock_guard<std::mutex> lock(impl->mutex);
+                                 slot->result.objects = objects;
+                                 slot->result.success = success;
+                                 slot->finished = true;
+                                 impl->inflight--;
+                                 impl->cv.notify_all();
+                             });
+}
+
+bool InferPipeline::poll(PipelineResult &result, const bool wait) {
+    std::unique_lock<std::mutex> lock(private_->mutex);
+    if (private_->slots.empty()) { return false; }
+
+    if (wait) {
+        private_->cv.wait(lock, [this] { return private_->slots.front()->finished; });
+    } else if (!private_->slots.front()->finished) {
+        return false;
+    }
+
+    result = std::move(private_->slots.front()->result);
+    private_->slots.pop_front();
+    return true;
+}
+
+size_t InferPipeline::pending() const {
+    std::lock_guard<std::mutex> lock(private_->mutex);
+    return private_->slots.size();
+}
+
+uint64_t InferPipeline::dropped() const {
+    std::lock_guard<std::mutex> lock(private_->mutex);
+    return private_->dropped;
+}
+
+}// namespace gddi
@@ -0,0 +1,140 @@
+#include "mock_infer_backend.h"
+#include <chrono>
+#include <condition_variable>
+#include <core/result_def.h>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <tuple>
+
+namespace gddi {
+
+class MockInferBackend::MockInferBackendPrivate {
+public:
+    std::vector<std::string> labels;
+
+    std::mutex infer_mutex;
+    uint64_t call_index{0};
+    std::mt19937 random_engine;
+
+    // 异步推理单线程执行, 模拟加速卡串行处理
+    std::mutex task_mutex;
+    std::condition_variable task_cv;
+    std::deque<std::tuple<InferTag, gddeploy::PackagePtr, InferBackendCallback>> tasks;
+    bool running_task{false};
+    bool stop{false};
+    std::thread worker;
+};
+
+MockInferBackend::MockInferBackend(const MockInferBackendConfig &config) : config_(config) {
+    private_ = std::make_unique<MockInferBackendPrivate>();
+    private_->random_engine.seed(config_.seed);
+
+    private_->worker = std::thread([this]() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(private_->task_mutex);
+            private_->task_cv.wait(lock, [this] { return private_->stop || !private_->tasks.empty(); });
+            if (private_->tasks.empty()) { break; }
+
+            auto task = std::move(private_->tasks.front());
+            private_->tasks.pop_front();
+            private_->running_task = true;
+            lock.unlock();
+
+            auto out_package = gddeploy::Package::Create(std::get<1>(task)->data.size());
+            auto success = infer_sync(std::get<0>(task), std::get<1>(task), out_package);
+            std::get<2>(task)(std::get<0>(task), success, out_package);
+
+            lock.lock();
+            private_->running_task = false;
+            private_->task_cv.notify_all();
+        }
+    });
+}
+
+MockInferBackend::~MockInferBackend() {
+    {
+        std::lock_guard<std::mutex> lock(private_->task_mutex);
+        private_->stop = true;
+        private_->task_cv.notify_all();
+    }
+    private_->worker.join();
+}
+
+bool MockInferBackend::load(const ModelConfig &model) {
+    private_->labels = config_.labels;
+    if (private_->labels.empty()) {
+        private_->labels.assign(model.labels.begin(), model.labels.end());
+        if (private_->labels.empty()) { private_->labels.emplace_back(model.name); }
+    }
+    return true;
+}
+
+bool MockInferBackend::infer_sync(const InferTag & /*tag*/, const gddeploy::PackagePtr &in_package,
+                                  gddeploy::PackagePtr &out_package) {
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(config_.latency + config_.item_latency * in_package->data.size()));
+
+    std::lock_guard<std::mutex> lock(private_->infer_mutex);
+    auto call_index = private_->call_index++;
+
+    for (size_t i = 0; i < in_package->data.size() && i < out_package->data.size(); i++) {
+        std::vector<MockDetection> detections;
+        if (config_.script) {
+            detections = config_.script(call_index, i);
+        } else {
+            // 随机生成目标
+            auto &engine = private_->random_engine;
+            auto object_number = std::uniform_int_distribution<uint32_t>(0, config_.max_objects)(engine);
+            for (uint32_t j = 0; j < object_number; j++) {
+                auto class_id = std::uniform_int_distribution<size_t>(0, private_->labels.size() - 1)(engine);
+                int width = std::uniform_int_distribution<int>(32, std::max(32, config_.input_size.width / 4))(engine);
+                int height =
+                    std::uniform_int_distribution<int>(32, std::max(32, config_.input_size.height / 2))(engine);
+                int x = std::uniform_int_distribution<int>(0, std::max(0, config_.input_size.width - width))(engine);
+                int y = std::uniform_int_distribution<int>(0, std::max(0, config_.input_size.height - height))(engine);
+                detections.emplace_back(MockDetection{(int)class_id, private_->labels[class_id],
+                                                      std::uniform_real_distribution<float>(0.1, 1.0)(engine),
+                                                      cv::Rect{x, y, width, height}});
+            }
+        }
+
+        gddeploy::DetectImg detect_img;
+        detect_img.img_id = i;
+        detect_img.img_w = config_.input_size.width;
+        detect_img.img_h = config_.input_size.height;
+        int detect_id = 0;
+        for (const auto &item : detections) {
+            gddeploy::DetectObject obj;
+            obj.detect_id = detect_id++;
+            obj.class_id = item.class_id;
+            obj.label = item.label;
+            obj.score = item.score;
+            obj.bbox = {(float)item.rect.x, (float)item.rect.y, (float)item.rect.width, (float)item.rect.height};
+            detect_img.detect_objs.emplace_back(obj);
+        }
+
+        gddeploy::InferResult infer_result;
+        infer_result.result_type.emplace_back(gddeploy::GDD_RESULT_TYPE_DETECT);
+        infer_result.detect_result.batch_size = 1;
+        infer_result.detect_result.detect_imgs.emplace_back(std::move(detect_img));
+        out_package->data[i]->SetMetaData(std::move(infer_result));
+    }
+
+    return true;
+}
+
+void MockInferBackend::infer_async(const InferTag &tag, const gddeploy::PackagePtr &in_package,
+                                   InferBackendCallback callback) {
+    std::lock_guard<std::mutex> lock(private_->task_mutex);
+    private_->tasks.emplace_back(tag, in_package, std::move(callback));
+    private_->task_cv.notify_all();
+}
+
+void MockInferBackend::wait_task_done() {
+    std::unique_lock<std::mutex> lock(private_->task_mutex);
+    private_->task_cv.wait(lock, [this] { return private_->tasks.empty() && !private_->running_task; });
+}
+
+}// namespace gddi
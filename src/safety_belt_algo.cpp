@@ -1,301 +1,131 @@
 #include "safety_belt_algo.h"
-#include "core/infer_server.h"
-#include "spdlog/spdlog.h"
-#include "utils.h"
-#include <api/global_config.h>
-#include <bmcv_api_ext.h>
-#include <common/type_convert.h>
-#include <core/alg_param.h>
+#include "cascade/cascade.h"
+#include <ctime>
+#include <map>
 #include <mutex>
 #include <utility>
 
 namespace gddi {
 
-class SafetyBeltAlgo::SafetyBeltAlgoPrivate {
-public:
+struct SafetyBeltStream {
     std::vector<int> light_group;
     std::time_t last_light_time{0};
 
     std::vector<std::pair<int, int>> safety_belt_group;
+};
 
-    std::mutex model_mutex;
-    std::vector<ModelConfig> model_configs;
-    std::vector<std::unique_ptr<gddeploy::InferAPI>> model_impls;
+class SafetyBeltAlgo::SafetyBeltAlgoPrivate {
+public:
+    std::mutex statistic_mutex;             // 各阶段异步回调线程不同, 统计需加锁
+    std::map<int, SafetyBeltStream> streams;// 各视频流独立统计
 };
 
 SafetyBeltAlgo::SafetyBeltAlgo(const SafetyBeltAlgoConfig &config) : config_(config) {
-    gddeploy::gddeploy_init("");
     private_ = std::make_unique<SafetyBeltAlgoPrivate>();
+
+    // 行人检测 (至少2人) -> 裁剪安全带检测 -> 安全带统计 -> 灯光检测 -> 灯光统计
+    cascade_ = std::make_unique<Cascade>(
+        "SafetyBeltAlgo", std::vector<CascadeStage>{
+                              CascadeStage::detect(0, {}, {}, true),
+                              CascadeStage::zone(),
+                              CascadeStage::finish_if([](const std::vector<AlgoObject> &objects) {
+                                  // 如果人数少于2，直接返回检测到的人员信息
+                                  return objects.size() < 2;
+                              }),
+                              CascadeStage::custom([](CascadeContext &context) {
+                                  context.named_objects["person"] = context.objects;
+                              }),
+                              CascadeStage::crop_detect(1, CropMerge::kOffset),
+                              CascadeStage::custom([this](CascadeContext &context) { update_safety_belt(context); }),
+                              CascadeStage::detect(2, {}, config_.light_cache),
+                              CascadeStage::custom([this](CascadeContext &context) { update_light(context); }),
+                          });
+    cascade_->set_motion_gate(config_.motion_gate);
+    cascade_->set_zone(config_.zone);
 }
 
 SafetyBeltAlgo::~SafetyBeltAlgo() {
-    std::lock_guard<std::mutex> lock(private_->model_mutex);
-    for (auto &impl : private_->model_impls) { impl->WaitTaskDone(); }
+    // 在途帧的阶段回调访问 private_ 与 config_, 需先于它们停止级联引擎
+    cascade_.reset();
 }
 
 bool SafetyBeltAlgo::load_models(const std::vector<ModelConfig> &models) {
-    if (models.size() != 3) {
-        spdlog::error("SafetyBeltAlgo requires exactly three models");
-        return false;
-    }
-
-    std::lock_guard<std::mutex> lock(private_->model_mutex);
-    private_->model_impls.clear();
-
-    private_->model_configs = models;
-    for (const auto &model : models) {
-        auto algo_impl = std::make_unique<gddeploy::InferAPI>();
-        if (algo_impl->Init("", model.path, model.license, gddeploy::ENUM_API_TYPE::ENUM_API_SESSION_API) != 0) {
-            spdlog::error("Failed to load model: {} - {}", model.name, model.path);
-            return false;
-        }
-        private_->model_impls.emplace_back(std::move(algo_impl));
-    }
-
-    return true;
+    return cascade_->load_models(models);
 }
 
 void SafetyBeltAlgo::async_infer(const int64_t image_id, const cv::Mat &image, InferCallback infer_callback) {
-    gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
-
-    auto package = gddeploy::Package::Create(1);
-    package->data[0]->Set(surface);
-    package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
-    private_->model_impls[0]->InferAsync(
-        package,
-        [this, image_id, image, surface, infer_callback](gddeploy::Status status, gddeploy::PackagePtr data,
-                                                         gddeploy::any user_data) {
-            std::vector<AlgoObject> person_objects;
-            if (!data->data.empty() && data->data[0]->HasMetaValue()) {
-                person_objects = filter_infer_result(data->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                     private_->model_configs[0].labels);
-            }
-
-            // 检测人数
-            if (person_objects.size() < 2) {
-                // 如果人数少于2，直接返回检测到的人员信息
-                if (infer_callback) { infer_callback(image_id, image, person_objects); }
-                return true;
-            }
-
-            // 对每个检测到的人进行安全带检测
-            std::vector<AlgoObject> belt_objects;
-            for (const auto &person : person_objects) {
-                auto crop_rect =
-                    scale_crop_rect(image.cols, image.rows, person.rect, private_->model_configs[1].crop_scale_factor);
-                auto crop_image = image(crop_rect).clone();
-
-                gddeploy::BufSurfWrapperPtr crop_surface;
-                convertMat2BufSurface(crop_image, crop_surface);
-                auto in_package = gddeploy::Package::Create(1);
-                auto out_package = gddeploy::Package::Create(1);
-                in_package->data[0]->Set(crop_surface);
-                in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[1].threshold,
-                                                                          private_->model_configs[1].nms_threshold});
-
-                private_->model_impls[1]->InferSync(in_package, out_package);
-
-                if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                    auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                       private_->model_configs[1].labels);
-                    belt_objects.insert(belt_objects.end(), objects.begin(), objects.end());
-                }
-            }
-
-            // 如果安全带统计小于阈值，则认为未戴安全带
-            private_->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
-            float safety_belt_count =
-                std::count_if(private_->safety_belt_group.begin(), private_->safety_belt_group.end(),
-                              [](const auto &pair) { return pair.first == 1; });
-            if (safety_belt_count / private_->safety_belt_group.size() < config_.safety_belt_threshold) {
-                if (infer_callback) { infer_callback(image_id, image, person_objects); }
-
-                // 重置灯光统计
-                private_->light_group.clear();
-                private_->last_light_time = 0;
-                return true;
-            }
-
-            if (std::time(nullptr) - private_->safety_belt_group.front().second >= config_.statistics_time) {
-                private_->safety_belt_group.erase(private_->safety_belt_group.begin());
-            }
-
-            // 检测灯光
-            if (private_->last_light_time == 0) { private_->last_light_time = std::time(nullptr); }
-
-            auto in_package = gddeploy::Package::Create(1);
-            in_package->data[0]->Set(surface);
-            in_package->data[0]->SetAlgParam(gddeploy::AlgDetectParam{private_->model_configs[2].threshold,
-                                                                      private_->model_configs[2].nms_threshold});
-
-            auto out_package = gddeploy::Package::Create(1);
-            if (private_->model_impls[2]->InferSync(in_package, out_package) != 0) { return true; }
-
-            if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-                auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                                   private_->model_configs[2].labels);
-                private_->light_group.emplace_back(objects.empty() ? 0 : 1);
-                if (std::time(nullptr) - private_->light_group.front() >= config_.light_threshold) {
-                    private_->light_group.erase(private_->light_group.begin());
-                }
-            }
-
-            // 灯光判断逻辑
-            if (std::time(nullptr) - private_->last_light_time >= config_.delay_time) {
-                if (!private_->light_group.empty()) {
-                    float count = std::count(private_->light_group.begin(), private_->light_group.end(), 1);
-                    if (count / private_->light_group.size() >= config_.light_threshold) {
-                        // 如果灯亮了，返回空结果（表示条件都满足）
-                        if (infer_callback) { infer_callback(image_id, image, {}); }
-                    } else {
-                        // 如果灯没亮，返回原始的人员检测结果
-                        if (infer_callback) { infer_callback(image_id, image, person_objects); }
-                    }
-                } else {
-                    if (infer_callback) { infer_callback(image_id, image, person_objects); }
-                }
-
-                // 重置灯光统计
-                private_->light_group.clear();
-                private_->last_light_time = 0;
-            }
-
-            return true;
-        });
+    async_infer(kDefaultStreamId, image_id, image, infer_callback);
 }
 
 bool SafetyBeltAlgo::sync_infer(const int64_t image_id, const cv::Mat &image, std::vector<AlgoObject> &person_objects) {
-    gddeploy::BufSurfWrapperPtr surface;
-    convertMat2BufSurface(const_cast<cv::Mat &>(image), surface);
-
-    auto in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-    in_package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[0].threshold, private_->model_configs[0].nms_threshold});
-
-    auto out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[0]->InferSync(in_package, out_package) != 0) { return false; }
+    return sync_infer(kDefaultStreamId, image_id, image, person_objects);
+}
 
-    std::vector<AlgoObject> infer_objects;
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        infer_objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                            private_->model_configs[0].labels);
-    }
+void SafetyBeltAlgo::async_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                                 InferCallback infer_callback) {
+    cascade_->async_infer(stream_id, image_id, image, infer_callback);
+}
 
-    // 检测人数
-    if (infer_objects.size() < 2) {
-        // 如果人数少于2，直接返回检测到的人员信息
-        person_objects = infer_objects;
-        return true;
-    }
+bool SafetyBeltAlgo::sync_infer(const int stream_id, const int64_t image_id, const cv::Mat &image,
+                                std::vector<AlgoObject> &person_objects) {
+    return cascade_->sync_infer(stream_id, image_id, image, person_objects);
+}
 
-    // 对每个检测到的人进行安全带检测
-    std::vector<AlgoObject> belt_objects;
-    for (const auto &person : infer_objects) {
-        auto crop_rect =
-            scale_crop_rect(image.cols, image.rows, person.rect, private_->model_configs[1].crop_scale_factor);
-        auto crop_image = image(crop_rect).clone();
+void SafetyBeltAlgo::release_stream(const int stream_id) {
+    cascade_->release_stream(stream_id);
 
-        gddeploy::BufSurfWrapperPtr crop_surface;
-        convertMat2BufSurface(crop_image, crop_surface);
-        in_package = gddeploy::Package::Create(1);
-        in_package->data[0]->Set(crop_surface);
-        in_package->data[0]->SetAlgParam(
-            gddeploy::AlgDetectParam{private_->model_configs[1].threshold, private_->model_configs[1].nms_threshold});
+    std::lock_guard<std::mutex> lock(private_->statistic_mutex);
+    private_->streams.erase(stream_id);
+}
 
-        out_package = gddeploy::Package::Create(1);
-        if (private_->model_impls[1]->InferSync(in_package, out_package) != 0) { return false; }
-
-        if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-            auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                               private_->model_configs[1].labels);
-            belt_objects.insert(belt_objects.end(), objects.begin(), objects.end());
-        }
-    }
+void SafetyBeltAlgo::update_safety_belt(CascadeContext &context) {
+    std::lock_guard<std::mutex> lock(private_->statistic_mutex);
+    auto &stream = private_->streams[context.stream_id];
 
     // 如果安全带统计小于阈值，则认为未戴安全带
-    private_->safety_belt_group.emplace_back(belt_objects.empty() ? 0 : 1, std::time(nullptr));
-    float safety_belt_count = std::count_if(private_->safety_belt_group.begin(), private_->safety_belt_group.end(),
+    stream.safety_belt_group.emplace_back(context.objects.empty() ? 0 : 1, std::time(nullptr));
+    float safety_belt_count = std::count_if(stream.safety_belt_group.begin(), stream.safety_belt_group.end(),
                                             [](const auto &pair) { return pair.first == 1; });
-    if (safety_belt_count / private_->safety_belt_group.size() < config_.safety_belt_threshold) {
-        person_objects = infer_objects;
+    if (safety_belt_count / stream.safety_belt_group.size() < config_.safety_belt_threshold) {
+        context.objects = context.named_objects["person"];
+        context.finished = true;
 
         // 重置灯光统计
-        private_->light_group.clear();
-        private_->last_light_time = 0;
-        return true;
+        stream.light_group.clear();
+        stream.last_light_time = 0;
+        return;
     }
 
-    if (std::time(nullptr) - private_->safety_belt_group.front().second >= config_.statistics_time) {
-        private_->safety_belt_group.erase(private_->safety_belt_group.begin());
+    if (std::time(nullptr) - stream.safety_belt_group.front().second >= config_.statistics_time) {
+        stream.safety_belt_group.erase(stream.safety_belt_group.begin());
     }
 
     // 检测灯光
-    if (private_->last_light_time == 0) { private_->last_light_time = std::time(nullptr); }
-
-    in_package = gddeploy::Package::Create(1);
-    in_package->data[0]->Set(surface);
-    in_package->data[0]->SetAlgParam(
-        gddeploy::AlgDetectParam{private_->model_configs[2].threshold, private_->model_configs[2].nms_threshold});
+    if (stream.last_light_time == 0) { stream.last_light_time = std::time(nullptr); }
+}
 
-    out_package = gddeploy::Package::Create(1);
-    if (private_->model_impls[2]->InferSync(in_package, out_package) != 0) { return false; }
+void SafetyBeltAlgo::update_light(CascadeContext &context) {
+    std::lock_guard<std::mutex> lock(private_->statistic_mutex);
+    auto &stream = private_->streams[context.stream_id];
 
-    if (!out_package->data.empty() && out_package->data[0]->HasMetaValue()) {
-        auto objects = filter_infer_result(out_package->data[0]->GetMetaData<gddeploy::InferResult>(),
-                                           private_->model_configs[2].labels);
-        private_->light_group.emplace_back(objects.empty() ? 0 : 1);
-        if (std::time(nullptr) - private_->light_group.front() >= config_.light_threshold) {
-            private_->light_group.erase(private_->light_group.begin());
-        }
+    stream.light_group.emplace_back(context.objects.empty() ? 0 : 1);
+    if (std::time(nullptr) - stream.light_group.front() >= config_.light_threshold) {
+        stream.light_group.erase(stream.light_group.begin());
     }
 
-    // 修改灯光判断逻辑
-    if (std::time(nullptr) - private_->last_light_time >= config_.delay_time) {
-        if (!private_->light_group.empty()) {
-            float count = std::count(private_->light_group.begin(), private_->light_group.end(), 1);
-            if (count / private_->light_group.size() >= config_.light_threshold) {
-                // 如果灯亮了，返回空结果（表示条件都满足）
-                person_objects = {};
-            } else {
-                // 如果灯没亮，返回原始的人员检测结果
-                person_objects = infer_objects;
-            }
-        } else {
-            person_objects = infer_objects;
+    // 灯光判断逻辑, 延迟时间内不输出
+    context.objects.clear();
+    if (stream.last_light_time != 0 && std::time(nullptr) - stream.last_light_time >= config_.delay_time) {
+        float count = std::count(stream.light_group.begin(), stream.light_group.end(), 1);
+        if (stream.light_group.empty() || count / stream.light_group.size() < config_.light_threshold) {
+            // 如果灯没亮，返回原始的人员检测结果
+            context.objects = context.named_objects["person"];
         }
 
         // 重置灯光统计
-        private_->light_group.clear();
-        private_->last_light_time = 0;
-    }
-
-    return true;
-}
-
-std::vector<AlgoObject> SafetyBeltAlgo::filter_infer_result(const gddeploy::InferResult &infer_result,
-                                                            const std::set<std::string> &labels) {
-    std::vector<AlgoObject> objects;
-
-    for (auto result_type : infer_result.result_type) {
-        if (result_type == gddeploy::GDD_RESULT_TYPE_DETECT) {
-            for (const auto &item : infer_result.detect_result.detect_imgs) {
-                int index = 1;
-                for (auto &obj : item.detect_objs) {
-                    if (labels.count(obj.label) == 0) { continue; }
-
-                    objects.emplace_back(
-                        AlgoObject{index++, obj.class_id, obj.label, obj.score,
-                                   cv::Rect{(int)obj.bbox.x, (int)obj.bbox.y, (int)obj.bbox.w, (int)obj.bbox.h}});
-                }
-            }
-        }
+        stream.light_group.clear();
+        stream.last_light_time = 0;
     }
-
-    return objects;
 }
 
 }// namespace gddi
@@ -0,0 +1,51 @@
+/**
+ * @file surface_utils.h
+ * @author zhdotcai (caizhehong@gddi.com.cn)
+ * @brief
+ * @version 1.0.0
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024 by GDDI
+ *
+ */
+
+#pragma once
+
+#include <common/type_convert.h>
+#include <opencv2/core/mat.hpp>
+#include <vector>
+
+namespace gddi {
+
+/**
+ * @brief 裁剪区域转换为推理输入
+ *
+ * 直接在原图 ROI 上转换, 不再 clone() 整块目标图像:
+ * - ROI 内存连续 (整行裁剪) 时原地转换, 主机端无额外拷贝
+ * - 否则 (宽度小于整帧的常见裁剪) 仍需紧凑拷贝一次到线程局部暂存区 (容量只增不减), 稳定后无内存分配
+ *
+ * 并非零拷贝: convertMat2BufSurface 按连续内存读取, 不接受行跨度 (pitch), 当前 SDK 的 BufSurface
+ * 也没有裁剪区域描述, 去掉这次拷贝需要 SDK 支持带跨度转换或设备端裁剪.
+ * convertMat2BufSurface 会拷贝数据到 surface, 暂存区可在下一个目标复用
+ *
+ * @param image   原图
+ * @param rect    裁剪区域, 需在图像范围内
+ * @param surface 输出
+ */
+inline void convert_crop_surface(const cv::Mat &image, const cv::Rect &rect, gddeploy::BufSurfWrapperPtr &surface) {
+    cv::Mat roi = image(rect);
+    if (roi.isContinuous()) {
+        convertMat2BufSurface(roi, surface);
+        return;
+    }
+
+    thread_local std::vector<uint8_t> staging_buffer;
+    size_t bytes = roi.total() * roi.elemSize();
+    if (staging_buffer.size() < bytes) { staging_buffer.resize(bytes); }
+
+    cv::Mat staging(roi.rows, roi.cols, roi.type(), staging_buffer.data());
+    roi.copyTo(staging);
+    convertMat2BufSurface(staging, surface);
+}
+
+}// namespace gddi